@@ -0,0 +1,388 @@
+#include <QApplication>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSet>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QXmlStreamReader>
+
+#include "editdistance.h"
+#include "fountainio.h"
+#include "linegridpaginator.h"
+#include "pageview.h"
+#include "screenplayio.h"
+#include "scriptgenerator.h"
+#include "scripteditor.h"
+#include "spellcheckservice.h"
+#include "texttokenizer.h"
+
+// Benchmarks over generated scripts of 1, 10, 120 and 500 pages. Run with
+//   screenqt_bench [--json results.json] [QtTest options]
+// Results are written as JSON (default screenqt_bench.json) so runs on
+// different commits can be compared.
+class ScreenqtBench : public QObject {
+    Q_OBJECT
+
+private:
+    static QVector<int> pageTargets() { return {1, 10, 120, 500}; }
+
+    void addPageRows()
+    {
+        QTest::addColumn<int>("pages");
+        for (int pages : pageTargets()) {
+            QTest::newRow(qPrintable(QString("%1p").arg(pages))) << pages;
+        }
+    }
+
+    const QVector<ScriptGenerator::Line> &script(int pages)
+    {
+        auto it = m_scripts.find(pages);
+        if (it == m_scripts.end()) {
+            it = m_scripts.insert(pages, ScriptGenerator::generate(pages));
+        }
+        return it.value();
+    }
+
+    QString scriptFile(int pages, const QString &format) const
+    {
+        return m_dir.filePath(QString("script_%1p.%2").arg(pages).arg(format));
+    }
+
+    QTemporaryDir m_dir;
+    QHash<int, QVector<ScriptGenerator::Line>> m_scripts;
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+        for (int pages : pageTargets()) {
+            PageView pv;
+            ScriptGenerator::populate(pv.editor(), script(pages));
+            QCoreApplication::processEvents();
+            qInfo("%d page target: %d blocks, %d pages laid out",
+                  pages, pv.editor()->document()->blockCount(), pv.pageCount());
+            QVERIFY(ScreenplayIO::saveDocument(pv.editor(), scriptFile(pages, "sqt")));
+            QVERIFY(ScreenplayIO::saveDocument(pv.editor(), scriptFile(pages, "fdx")));
+            QVERIFY(FountainIO::saveFountain(pv.editor(), scriptFile(pages, "fountain")));
+        }
+    }
+
+    void load_data()
+    {
+        QTest::addColumn<int>("pages");
+        QTest::addColumn<QString>("format");
+        for (const QString format : {"sqt", "fdx", "fountain"}) {
+            for (int pages : pageTargets()) {
+                QTest::newRow(qPrintable(QString("%1/%2p").arg(format).arg(pages))) << pages << format;
+            }
+        }
+    }
+
+    void load()
+    {
+        QFETCH(int, pages);
+        QFETCH(QString, format);
+        const QString path = scriptFile(pages, format);
+        PageView pv;
+        QBENCHMARK {
+            if (format == "fountain") {
+                QVERIFY(FountainIO::loadFountain(pv.editor(), path));
+            } else {
+                QVERIFY(pv.loadFromFile(path));
+            }
+            QCoreApplication::processEvents();
+        }
+    }
+
+    void save_data() { addPageRows(); }
+    void save()
+    {
+        QFETCH(int, pages);
+        PageView pv;
+        ScriptGenerator::populate(pv.editor(), script(pages));
+        const QString path = m_dir.filePath("save.sqt");
+        QBENCHMARK {
+            QVERIFY(pv.saveToFile(path));
+        }
+    }
+
+    void formatDocument_data() { addPageRows(); }
+    void formatDocument()
+    {
+        QFETCH(int, pages);
+        PageView pv;
+        ScriptGenerator::populate(pv.editor(), script(pages));
+        QCoreApplication::processEvents();
+        QBENCHMARK {
+            pv.editor()->formatDocument();
+        }
+    }
+
+    // Full repagination, the work enforcePageBreaks() used to do on every edit
+    void paginate_data() { addPageRows(); }
+    void paginate()
+    {
+        QFETCH(int, pages);
+        PageView pv;
+        ScriptGenerator::populate(pv.editor(), script(pages));
+        QCoreApplication::processEvents();
+        QTextDocument *doc = pv.editor()->document();
+        QBENCHMARK {
+            doc->markContentsDirty(0, doc->characterCount());
+        }
+        QVERIFY(pv.pageCount() >= 1);
+    }
+
+    // Headless page count on the line grid; the target is under 5 ms at 300 pages
+    void lineGridPaginate_data()
+    {
+        QTest::addColumn<int>("pages");
+        for (int pages : {120, 300, 500}) {
+            QTest::newRow(qPrintable(QString("%1p").arg(pages))) << pages;
+        }
+    }
+
+    void lineGridPaginate()
+    {
+        QFETCH(int, pages);
+        ScriptEditor editor;
+        ScriptGenerator::populate(&editor, script(pages));
+        const LineGridPaginator paginator;
+        LineGridPaginator::Result result;
+        QBENCHMARK {
+            result = paginator.paginate(editor.document());
+        }
+        QVERIFY(result.pageCount >= 1);
+    }
+
+    // A burst of typing in the middle of the script, with events flushed as the UI would
+    void typingBurst_data() { addPageRows(); }
+    void typingBurst()
+    {
+        QFETCH(int, pages);
+        PageView pv;
+        ScriptGenerator::populate(pv.editor(), script(pages));
+        pv.show();
+        QVERIFY(QTest::qWaitForWindowExposed(&pv));
+
+        QTextDocument *doc = pv.editor()->document();
+        QTextCursor cursor(doc->findBlockByNumber(doc->blockCount() / 2));
+        cursor.movePosition(QTextCursor::EndOfBlock);
+        pv.editor()->setTextCursor(cursor);
+        QBENCHMARK {
+            QTest::keyClicks(pv.editor(), " The door creaks open");
+            QCoreApplication::processEvents();
+        }
+    }
+
+    void find_data() { addPageRows(); }
+    void find()
+    {
+        QFETCH(int, pages);
+        ScriptEditor editor;
+        ScriptGenerator::populate(&editor, script(pages));
+        QBENCHMARK {
+            editor.setFindQuery(QString());
+            editor.setFindQuery("door");
+        }
+        QVERIFY(editor.findMatchCount() > 0 || pages == 1);
+    }
+
+    void spellcheck_data() { addPageRows(); }
+    void spellcheck()
+    {
+        QFETCH(int, pages);
+        ScriptEditor editor;
+        ScriptGenerator::populate(&editor, script(pages));
+        const QString text = editor.toPlainText();
+        BasicSpellChecker checker;
+        int misspellings = 0;
+        QBENCHMARK {
+            misspellings = checker.checkText(text).size();
+        }
+        QVERIFY(misspellings >= 0);
+    }
+
+    // Word splitting for spellcheck and word counts: the regular expressions it replaced
+    // against the span tokenizer
+    void tokenize_data()
+    {
+        QTest::addColumn<QString>("tokenizer");
+        for (const QString tokenizer : {"regex", "spans"}) {
+            QTest::newRow(qPrintable(tokenizer)) << tokenizer;
+        }
+    }
+
+    void tokenize()
+    {
+        QFETCH(QString, tokenizer);
+        ScriptEditor editor;
+        ScriptGenerator::populate(&editor, script(120));
+        const QString text = editor.toPlainText();
+        static const QRegularExpression wordRegex("[A-Za-z][A-Za-z']*");
+        static const QRegularExpression whitespace("\\s+");
+        int total = 0;
+        QBENCHMARK {
+            total = 0;
+            if (tokenizer == "regex") {
+                QRegularExpressionMatchIterator it = wordRegex.globalMatch(text);
+                while (it.hasNext()) {
+                    total += it.next().captured(0).size() > 2;
+                }
+                total += text.split(whitespace, Qt::SkipEmptyParts).size();
+            } else {
+                TextTokenizer::SpellingWords words(text);
+                TextTokenizer::Token token;
+                while (words.next(token)) {
+                    total += token.length > 2;
+                }
+                total += TextTokenizer::countWords(text);
+            }
+        }
+        QVERIFY(total > 0);
+    }
+
+    // Suggestion ranking kernels over every pair of distinct words in a 120-page script
+    void editDistance_data()
+    {
+        QTest::addColumn<QString>("kernel");
+        for (const QString kernel : {"dp", "bitParallel", "bounded"}) {
+            QTest::newRow(qPrintable(kernel)) << kernel;
+        }
+    }
+
+    void editDistance()
+    {
+        QFETCH(QString, kernel);
+        QSet<QString> distinct;
+        for (const ScriptGenerator::Line &line : script(120)) {
+            for (const QString &word : line.text.toLower().split(QRegularExpression("[^a-z']+"), Qt::SkipEmptyParts)) {
+                distinct.insert(word);
+            }
+        }
+        const QStringList words(distinct.cbegin(), distinct.cend());
+        qint64 total = 0;
+        QBENCHMARK {
+            total = 0;
+            for (const QString &a : words) {
+                for (const QString &b : words) {
+                    if (kernel == "dp") {
+                        total += EditDistance::levenshtein(a, b);
+                    } else if (kernel == "bitParallel") {
+                        total += EditDistance::bitParallel(a, b);
+                    } else {
+                        total += EditDistance::bounded(a, b, 2);
+                    }
+                }
+            }
+        }
+        QVERIFY(total > 0);
+    }
+
+    void exportPdf_data() { addPageRows(); }
+    void exportPdf()
+    {
+        QFETCH(int, pages);
+        PageView pv;
+        ScriptGenerator::populate(pv.editor(), script(pages));
+        QCoreApplication::processEvents();
+        const QString path = m_dir.filePath("export.pdf");
+        QBENCHMARK {
+            QVERIFY(pv.exportToPdf(path));
+        }
+    }
+};
+
+namespace {
+
+// Collects the BenchmarkResult elements of QtTest's XML log into a JSON report
+bool writeJsonReport(const QString &xmlPath, const QString &jsonPath)
+{
+    QFile xmlFile(xmlPath);
+    if (!xmlFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QJsonArray results;
+    QString function;
+    QXmlStreamReader xml(&xmlFile);
+    while (!xml.atEnd()) {
+        if (xml.readNext() != QXmlStreamReader::StartElement) {
+            continue;
+        }
+        if (xml.name() == QLatin1String("TestFunction")) {
+            function = xml.attributes().value("name").toString();
+        } else if (xml.name() == QLatin1String("BenchmarkResult")) {
+            const QXmlStreamAttributes attributes = xml.attributes();
+            QJsonObject result;
+            result["benchmark"] = function;
+            result["tag"] = attributes.value("tag").toString();
+            result["metric"] = attributes.value("metric").toString();
+            result["value"] = attributes.value("value").toDouble();
+            result["iterations"] = attributes.value("iterations").toInt();
+            results.append(result);
+        }
+    }
+    if (xml.hasError()) {
+        return false;
+    }
+
+    QJsonObject root;
+    root["qtVersion"] = QString::fromLatin1(qVersion());
+    root["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["label"] = qEnvironmentVariable("SCREENQT_BENCH_LABEL");
+    root["results"] = results;
+
+    QFile jsonFile(jsonPath);
+    if (!jsonFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    jsonFile.write(QJsonDocument(root).toJson());
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // Benchmarks never need a display
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    // Editors load the user dictionary; timings must not depend on this machine's words
+    QStandardPaths::setTestModeEnabled(true);
+
+    QStringList args = app.arguments();
+    QString jsonPath = "screenqt_bench.json";
+    const int jsonIndex = args.indexOf("--json");
+    if (jsonIndex >= 0 && jsonIndex + 1 < args.size()) {
+        jsonPath = args.at(jsonIndex + 1);
+        args.remove(jsonIndex, 2);
+    }
+
+    QTemporaryDir logDir;
+    const QString xmlPath = logDir.filePath("screenqt_bench.xml");
+    args << "-o" << "-,txt" << "-o" << xmlPath + ",xml";
+
+    ScreenqtBench bench;
+    const int status = QTest::qExec(&bench, args);
+    if (!writeJsonReport(xmlPath, jsonPath)) {
+        qWarning("Could not write benchmark results to %s", qPrintable(jsonPath));
+        return status ? status : 1;
+    }
+    qInfo("Benchmark results written to %s", qPrintable(jsonPath));
+    return status;
+}
+
+#include "screenqt_bench.moc"
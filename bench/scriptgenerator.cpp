@@ -0,0 +1,183 @@
+#include "scriptgenerator.h"
+
+#include "scripteditor.h"
+
+#include <QStringList>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+
+namespace {
+
+// Lines a page holds at 6 lines per inch inside 9" of printable height
+constexpr int kLinesPerPage = 54;
+
+// Approximate wrap widths in characters for Courier 12 pt
+constexpr int kActionColumns = 60;
+constexpr int kDialogueColumns = 35;
+
+// xorshift32: tiny, fast and identical everywhere, unlike std:: distributions
+class Random {
+public:
+    explicit Random(quint32 seed) : m_state(seed ? seed : 0x9e3779b9u) {}
+
+    quint32 next()
+    {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return m_state;
+    }
+
+    int below(int bound) { return static_cast<int>(next() % static_cast<quint32>(bound)); }
+    bool chance(int percent) { return below(100) < percent; }
+
+    template <typename T>
+    const T &pick(const QVector<T> &items) { return items.at(below(items.size())); }
+
+private:
+    quint32 m_state;
+};
+
+const QVector<QString> kLocations = {
+    "APARTMENT", "KITCHEN", "POLICE STATION", "DINER", "PARKING GARAGE", "ROOFTOP",
+    "HOSPITAL CORRIDOR", "MOTEL ROOM", "HIGHWAY", "OFFICE", "WAREHOUSE", "BEACH",
+    "SUBWAY PLATFORM", "CHURCH", "BACKYARD", "BAR", "LIBRARY", "FOREST CLEARING"
+};
+const QVector<QString> kTimes = { "DAY", "NIGHT", "MORNING", "DUSK", "LATER", "CONTINUOUS" };
+const QVector<QString> kCharacters = {
+    "MAYA", "DETECTIVE RUIZ", "ELLIOT", "GRACE", "SAM", "DR. OKAFOR", "LENA",
+    "THE STRANGER", "MARCUS", "OFFICER PIKE", "JUNE", "WALTER"
+};
+const QVector<QString> kSubjects = {
+    "Maya", "Ruiz", "Elliot", "Grace", "The stranger", "A dog", "The crowd", "Rain",
+    "Headlights", "A phone", "Marcus", "June"
+};
+const QVector<QString> kVerbs = {
+    "crosses to the window", "slams the door", "studies the photograph", "hesitates",
+    "pulls out a crumpled note", "glances over a shoulder", "sinks into the chair",
+    "pours two cups of coffee", "checks the time", "steps into the light",
+    "tears the envelope open", "sweeps across the empty room"
+};
+const QVector<QString> kDetails = {
+    "without a word", "as thunder rolls somewhere far off", "hands trembling",
+    "while the radio crackles", "and waits", "under the flicker of a broken sign",
+    "as if nothing happened", "slowly", "before anyone notices"
+};
+// One line carries a deliberate misspelling so spellcheck always has work to do
+const QVector<QString> kDialogue = {
+    "I told you we should have left before midnight.",
+    "You don't get to decide that for me.",
+    "Where were you on the night of the fire?",
+    "It's not what it looks like.",
+    "Listen to me. We have maybe ten minutes before they figure it out.",
+    "I kept every letter. Every single one.",
+    "Don't.",
+    "If you walk out that door, don't bother coming back.",
+    "He knew. He knew the whole time and he said nothing.",
+    "We recieve a call like this once a year, maybe twice.",
+    "Fine. But we do it my way this time.",
+    "Tell me the truth and I'll let you go."
+};
+const QVector<QString> kParentheticals = {
+    "(beat)", "(quietly)", "(to Ruiz)", "(without looking up)", "(laughing)", "(re: the note)"
+};
+const QVector<QString> kTransitions = { "CUT TO:", "DISSOLVE TO:", "SMASH CUT TO:", "MATCH CUT TO:" };
+const QVector<QString> kShots = { "CLOSE ON THE NOTE", "ANGLE ON THE DOOR", "WIDE SHOT", "INSERT - THE PHOTOGRAPH" };
+
+int wrappedLines(const QString &text, int columns)
+{
+    return qMax(1, (static_cast<int>(text.size()) + columns - 1) / columns);
+}
+
+QString actionParagraph(Random &random)
+{
+    QStringList sentences;
+    const int count = 1 + random.below(4);
+    for (int i = 0; i < count; ++i) {
+        QString sentence = random.pick(kSubjects) + " " + random.pick(kVerbs);
+        if (random.chance(50)) {
+            sentence += " " + random.pick(kDetails);
+        }
+        sentences.append(sentence + ".");
+    }
+    return sentences.join(' ');
+}
+
+QString dialogueSpeech(Random &random)
+{
+    QStringList sentences;
+    const int count = 1 + random.below(3);
+    for (int i = 0; i < count; ++i) {
+        sentences.append(random.pick(kDialogue));
+    }
+    return sentences.join(' ');
+}
+
+} // namespace
+
+namespace ScriptGenerator {
+
+QVector<Line> generate(int targetPages, quint32 seed)
+{
+    Random random(seed);
+    QVector<Line> lines;
+    const int targetLines = qMax(1, targetPages) * kLinesPerPage;
+    int usedLines = 0;
+
+    // Each block costs its wrapped lines plus the blank line element spacing adds
+    auto add = [&](ScriptEditor::ElementType type, const QString &text, int columns, int spacing) {
+        lines.append(Line{static_cast<int>(type), text});
+        usedLines += wrappedLines(text, columns) + spacing;
+    };
+
+    while (usedLines < targetLines) {
+        const QString heading = QString("%1. %2 - %3")
+                                    .arg(random.chance(65) ? QStringLiteral("INT") : QStringLiteral("EXT"),
+                                         random.pick(kLocations), random.pick(kTimes));
+        add(ScriptEditor::SceneHeading, heading, kActionColumns, 2);
+        add(ScriptEditor::Action, actionParagraph(random), kActionColumns, 1);
+
+        const int beats = 3 + random.below(8);
+        for (int beat = 0; beat < beats && usedLines < targetLines; ++beat) {
+            const int roll = random.below(100);
+            if (roll < 60) {
+                add(ScriptEditor::CharacterName, random.pick(kCharacters), kActionColumns, 1);
+                if (random.chance(15)) {
+                    add(ScriptEditor::Parenthetical, random.pick(kParentheticals), kDialogueColumns, 0);
+                }
+                add(ScriptEditor::Dialogue, dialogueSpeech(random), kDialogueColumns, 0);
+            } else if (roll < 95) {
+                add(ScriptEditor::Action, actionParagraph(random), kActionColumns, 1);
+            } else {
+                add(ScriptEditor::Shot, random.pick(kShots), kActionColumns, 1);
+            }
+        }
+
+        if (random.chance(30)) {
+            add(ScriptEditor::Transition, random.pick(kTransitions), kActionColumns, 1);
+        }
+    }
+    return lines;
+}
+
+void populate(ScriptEditor *editor, const QVector<Line> &lines)
+{
+    // Same shape as loading an .sqt file: one edit block, then format by element
+    editor->clear();
+    QTextCursor cursor(editor->document());
+    cursor.beginEditBlock();
+    for (int i = 0; i < lines.size(); ++i) {
+        if (i > 0) {
+            cursor.insertBlock();
+        }
+        cursor.insertText(lines.at(i).text);
+        cursor.block().setUserState(lines.at(i).type);
+    }
+    cursor.endEditBlock();
+
+    editor->moveCursor(QTextCursor::Start);
+    editor->formatDocument();
+}
+
+} // namespace ScriptGenerator
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+class ScriptEditor;
+
+// Deterministic screenplay generator for benchmarks. The same seed and page
+// target produce the same script on every platform: a mix of scene headings,
+// action, character cues, parentheticals, dialogue and transitions in roughly
+// the proportions of a produced feature script.
+namespace ScriptGenerator {
+
+struct Line {
+    int type = 0; // ScriptEditor::ElementType
+    QString text;
+};
+
+QVector<Line> generate(int targetPages, quint32 seed = 20260301u);
+
+// Replaces the editor's contents in one edit block and formats every element
+void populate(ScriptEditor *editor, const QVector<Line> &lines);
+
+} // namespace ScriptGenerator
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QStringList>
+#include <QStringView>
+#include <QtGlobal>
+
+#include "fnv1a.h"
+
+// The built-in lexicon from data/base_dictionary.txt, compiled by screenqt_gendict
+// into a constexpr perfect-hash table. A lookup hashes the word's UTF-16 units twice
+// and compares one slot, without allocating or building a QString.
+namespace BaseDictionary {
+
+// FNV-1a over UTF-16 units from the given basis; the generator places words with it
+constexpr quint32 hash(QStringView word, quint32 basis)
+{
+    return Fnv1a::hash(word.utf16(), static_cast<std::size_t>(word.size()), basis);
+}
+
+// word must already be lower-case
+bool contains(QStringView word);
+int size();
+// Every word, for indexes that need the whole list
+QStringList words();
+
+} // namespace BaseDictionary
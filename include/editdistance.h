@@ -0,0 +1,23 @@
+#pragma once
+
+#include <QStringView>
+
+// Levenshtein distance between words, for ranking spelling suggestions.
+namespace EditDistance {
+
+// Longest shorter word the bit-parallel kernels handle in one machine word
+constexpr int kMaxBitParallelLength = 64;
+
+// Row-by-row dynamic programming; the reference the kernels are checked against
+int levenshtein(QStringView a, QStringView b);
+
+// Myers' bit-parallel algorithm in Hyyrö's formulation: one pass of word-wide bit
+// operations per character of the longer word and no heap allocation. Falls back to
+// levenshtein() when the shorter word exceeds kMaxBitParallelLength units.
+int bitParallel(QStringView a, QStringView b);
+
+// The distance when it is at most maxDistance, otherwise maxDistance + 1. Stops as
+// soon as the remaining characters can no longer bring the distance within bounds.
+int bounded(QStringView a, QStringView b, int maxDistance);
+
+} // namespace EditDistance
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Qt-free so screenqt_gendict can build without linking Qt
+namespace Fnv1a {
+
+// FNV-1a over code units from the given basis; units are hashed unsigned, so a char
+// sequence and the UTF-16 of the same ASCII text hash alike
+template <typename Unit>
+constexpr std::uint32_t hash(const Unit *units, std::size_t size, std::uint32_t basis)
+{
+    std::uint32_t h = basis;
+    for (std::size_t i = 0; i < size; ++i) {
+        h ^= static_cast<std::make_unsigned_t<Unit>>(units[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+} // namespace Fnv1a
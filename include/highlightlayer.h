@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QAbstractTextDocumentLayout>
+#include <QTextCharFormat>
+#include <QVector>
+#include <array>
+
+class QTextDocument;
+
+// Highlights painted over the script: spelling underlines and find matches.
+// Ranges are stored as sorted (start, length) pairs per kind and only turned
+// into layout selections for the span being painted, so a query with
+// thousands of matches costs no more per repaint than the visible ones.
+class HighlightLayer {
+public:
+    enum Kind {
+        Spelling = 0,
+        FindMatch,
+        KindCount
+    };
+
+    struct Range {
+        int start = 0;
+        int length = 0;
+    };
+
+    void setFormat(Kind kind, const QTextCharFormat &format, const QTextCharFormat &activeFormat = QTextCharFormat());
+    // Ranges must be sorted by start and must not overlap
+    void setRanges(Kind kind, const QVector<Range> &ranges, int activeIndex = -1);
+    const QVector<Range> &ranges(Kind kind) const { return m_layers[kind].ranges; }
+    // For an owner that keeps the list current in place; a second copy would make every
+    // edit detach and deep-copy it
+    QVector<Range> &mutableRanges(Kind kind) { return m_layers[kind].ranges; }
+    void setActiveIndex(Kind kind, int activeIndex) { m_layers[kind].activeIndex = activeIndex; }
+
+    // Edit bookkeeping for a sorted range list: drops the ranges starting in the edited
+    // span [start, oldEnd) and shifts the ones after it by delta. Returns the index at
+    // which ranges found in the edited span belong.
+    static int removeEditedRanges(QVector<Range> &ranges, int start, int oldEnd, int delta);
+
+    // Appends selections for the ranges overlapping [from, to), spelling first
+    void appendSelections(QTextDocument *document, int from, int to,
+                          QVector<QAbstractTextDocumentLayout::Selection> &selections) const;
+
+private:
+    struct Layer {
+        QVector<Range> ranges;
+        int activeIndex = -1;
+        QTextCharFormat format;
+        QTextCharFormat activeFormat;
+    };
+
+    std::array<Layer, KindCount> m_layers;
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QWidget>
+
+class QLabel;
+class QTimer;
+
+// Live per-stage typing latency table read from LatencyTrace
+class LatencyHud : public QWidget {
+    Q_OBJECT
+public:
+    explicit LatencyHud(QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+    void refreshStats();
+    void resetStats();
+
+private:
+    QLabel *m_table = nullptr;
+    QLabel *m_traceLabel = nullptr;
+    QTimer *m_refreshTimer = nullptr;
+};
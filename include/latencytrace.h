@@ -0,0 +1,95 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+#include <array>
+
+// Typing latency instrumentation. A Scope placed around a pipeline stage
+// records its wall time into that stage's log-scaled histogram, from which the
+// HUD reads p50/p95/p99. When SCREENQT_TRACE_FILE is set every sample is also
+// kept as a Chrome trace event and written to that path when the app exits
+// (open it in chrome://tracing or Perfetto).
+//
+// Samples are recorded on the GUI thread only.
+class LatencyTrace {
+public:
+    enum Stage {
+        KeyPress = 0,
+        UndoCommand,
+        Layout,
+        FindMatches,
+        Spellcheck,
+        OutlineRefresh,
+        CharactersRefresh,
+        DirtyFlag,
+        StatusUpdate,
+        StageCount
+    };
+
+    struct StageStats {
+        qint64 count = 0;
+        double p50Us = 0;
+        double p95Us = 0;
+        double p99Us = 0;
+        double maxUs = 0;
+    };
+
+    // Times the enclosing block. Nested scopes of the same stage (a compound
+    // undo command running its children, say) count once, as the outermost.
+    class Scope {
+    public:
+        explicit Scope(Stage stage);
+        ~Scope();
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        Stage m_stage;
+        qint64 m_startNs = -1;
+    };
+
+    static LatencyTrace &instance();
+    static const char *stageName(Stage stage);
+
+    void record(Stage stage, qint64 startNs, qint64 durationNs);
+    StageStats stats(Stage stage) const;
+    void reset();
+
+    bool chromeTraceEnabled() const { return !m_chromeTracePath.isEmpty(); }
+    QString chromeTracePath() const { return m_chromeTracePath; }
+    void setChromeTracePath(const QString &path); // Empty path stops collecting events
+    bool writeChromeTrace(const QString &path) const;
+
+    qint64 nowNs() const;
+
+private:
+    LatencyTrace();
+
+    // Four buckets per power of two of microseconds, up to about 17 minutes
+    static constexpr int kBucketsPerOctave = 4;
+    static constexpr int kBucketCount = 30 * kBucketsPerOctave;
+    static constexpr int kMaxTraceEvents = 1000000;
+
+    struct Histogram {
+        std::array<quint32, kBucketCount> buckets{};
+        qint64 count = 0;
+        qint64 maxNs = 0;
+    };
+
+    struct TraceEvent {
+        qint64 startNs;
+        qint64 durationNs;
+        Stage stage;
+    };
+
+    static int bucketForNs(qint64 durationNs);
+    static double bucketUpperUs(int bucket);
+    double percentileUs(const Histogram &histogram, double fraction) const;
+
+    std::array<Histogram, StageCount> m_histograms;
+    std::array<int, StageCount> m_depth{};
+    QVector<TraceEvent> m_events;
+    QString m_chromeTracePath;
+    qint64 m_epochNs = 0;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include "paginationmodel.h"
+
+class QTextDocument;
+
+// Screenplay pagination on the fixed-pitch line grid (Courier, 10 characters
+// and 6 lines per inch) computed from block text and element type alone.
+// No QTextLayout and no screen DPI are involved, so it works headlessly and
+// gives the same page count on every machine.
+class LineGridPaginator {
+public:
+    struct Settings {
+        int charactersPerInch = 10;
+        int linesPerPage = 54; // 9" printable height at 6 lines per inch
+    };
+
+    // Horizontal placement inside the 6" text column and blank lines before the element
+    struct ElementGeometry {
+        double leftInches = 0.0;
+        double widthInches = 6.0;
+        int spaceBeforeLines = 0;
+    };
+
+    struct Block {
+        int elementType = 0;
+        QString text;
+    };
+
+    struct Result {
+        int pageCount = 1;
+        int lineCount = 0;
+        QVector<int> pageFirstBlocks; // First block of pages 2..N
+        QVector<PaginationModel::ContinuationMarker> continuationMarkers;
+    };
+
+    explicit LineGridPaginator(const Settings &settings = Settings());
+
+    static ElementGeometry elementGeometry(int elementType);
+    // Greedy word wrap matching QTextLayout's WrapAtWordBoundaryOrAnywhere on a monospace font
+    static int wrappedLineCount(QStringView text, int columns);
+
+    int columnsForElement(int elementType) const;
+    int blockLineCount(int elementType, QStringView text) const;
+    Result paginate(const QVector<Block> &blocks) const;
+    Result paginate(const QTextDocument *document) const;
+
+private:
+    struct Walk {
+        int linesOnPage = 0;
+        Result result;
+    };
+    void startPage(Walk &walk, int blockNumber, int elementType) const;
+    void step(Walk &walk, int blockNumber, int elementType, QStringView text) const;
+
+    Settings m_settings;
+    QVector<int> m_columns; // Wrap width per element type
+};
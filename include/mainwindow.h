@@ -15,6 +15,7 @@ class QTimer;
 class CharactersPanel;
 class ElementTypePanel;
 class FindBar;
+class LatencyHud;
 class OutlinePanel;
 class PageView;
 class StartScreen;
@@ -91,6 +92,7 @@ private:
     // Edit actions
     QAction *m_undoAction         = nullptr;
     QAction *m_redoAction         = nullptr;
+    QAction *m_restoreHistoryAction = nullptr;
     QAction *m_findAction         = nullptr;
     QAction *m_findNextAction     = nullptr;
     QAction *m_findPreviousAction = nullptr;
@@ -101,17 +103,20 @@ private:
     QAction *m_zoomOutAction    = nullptr;
     QAction *m_resetZoomAction  = nullptr;
     QAction *m_resetLayoutAction = nullptr;
+    QAction *m_latencyHudAction  = nullptr;
     QAction *m_statsAction      = nullptr;
 
     // Panels
     ElementTypePanel *m_typePanel       = nullptr;
     OutlinePanel     *m_outlinePanel    = nullptr;
     CharactersPanel  *m_charactersPanel = nullptr;
+    LatencyHud       *m_latencyHud      = nullptr;
 
     // Docks
     QDockWidget *m_elementDock    = nullptr;
     QDockWidget *m_outlineDock    = nullptr;
     QDockWidget *m_charactersDock = nullptr;
+    QDockWidget *m_latencyDock    = nullptr;
 
     // Status bar labels
     QLabel *m_elementStatusLabel = nullptr;
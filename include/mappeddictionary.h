@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QtGlobal>
+
+// A read-only word list compiled to a DAWG (a trie whose identical suffixes are
+// shared) and memory-mapped from disk. Opening costs one mmap regardless of
+// size and lookups walk the mapped nodes in place, so a 100k-word dictionary
+// takes next to no private memory.
+//
+// File layout, all integers little-endian:
+//   header  "SQTDAWG1", version, wordCount, nodeCount, edgeCount, root (u32 each)
+//   nodes   firstEdge (u32), edgeCount | terminal flag in bit 31 (u32)
+//   edges   label (UTF-16 unit, u16), reserved (u16), target node (u32),
+//           sorted by label within a node
+//
+// Words are stored lower-cased.
+class MappedDictionary {
+public:
+    MappedDictionary() = default;
+    MappedDictionary(const MappedDictionary &) = delete;
+    MappedDictionary &operator=(const MappedDictionary &) = delete;
+
+    // Writes words to path in the format above; duplicates and case are folded
+    static bool compile(const QStringList &words, const QString &path, QString *error = nullptr);
+    // Reads a plain list (one word per line) or a Hunspell .dic (count line, word/FLAGS)
+    static QStringList readWordList(const QString &path, QString *error = nullptr);
+
+    bool open(const QString &path, QString *error = nullptr);
+    bool isOpen() const { return m_data != nullptr; }
+    int wordCount() const { return static_cast<int>(m_wordCount); }
+
+    // word must already be lower-case
+    bool contains(QStringView word) const;
+    // Words within maxDistance edits, closest first and alphabetical within a distance
+    QStringList suggestions(QStringView word, int maxDistance, int maxResults) const;
+
+private:
+    struct Node {
+        quint32 firstEdge = 0;
+        quint32 edgeCount = 0;
+        bool terminal = false;
+    };
+
+    struct Search;
+
+    void search(Search &state, quint32 index, const int *previousRow) const;
+    Node node(quint32 index) const;
+    quint16 edgeLabel(quint32 edge) const;
+    quint32 edgeTarget(quint32 edge) const;
+    bool child(const Node &parent, char16_t label, quint32 &target) const;
+
+    QFile m_file;
+    const uchar *m_data = nullptr;
+    const uchar *m_nodes = nullptr;
+    const uchar *m_edges = nullptr;
+    quint32 m_wordCount = 0;
+    quint32 m_nodeCount = 0;
+    quint32 m_edgeCount = 0;
+    quint32 m_root = 0;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "mappeddictionary.h"
+#include "spellcheckservice.h"
+#include "userdictionary.h"
+
+#include <QCache>
+#include <QMutex>
+
+// Spellchecker over a compiled, memory-mapped dictionary (see MappedDictionary and
+// the screenqt_mkdict tool). Used where the platform offers no system checker and a
+// dictionary file is installed.
+class MappedDictionarySpellChecker final : public AbstractSpellChecker {
+public:
+    // Words added with addWord() are saved to userDictionaryPath when one is given
+    explicit MappedDictionarySpellChecker(const QString &dictionaryPath, const QString &userDictionaryPath = QString());
+
+    // $SCREENQT_DICTIONARY when set, else dictionaries/en_US.sqtdict beside the executable
+    static QString defaultDictionaryPath();
+
+    bool isAvailable() const override { return m_dictionary.isOpen(); }
+    QList<Misspelling> checkText(const QString &text) const override;
+    QStringList suggestionsFor(const QString &word) const override;
+    void addWord(const QString &word) override;
+    bool supportsBackgroundChecks() const override { return true; }
+
+private:
+    bool isKnownWord(QStringView word) const;
+
+    MappedDictionary m_dictionary;
+    UserDictionary m_userDictionary;
+    mutable QCache<QString, QStringList> m_suggestionCache{256};
+    mutable QMutex m_suggestionMutex;
+};
@@ -1,24 +1,27 @@
 #pragma once
 #include <QWidget>
+#include <QFont>
+#include <QPicture>
+#include <QPixmap>
 #include <QRect>
 #include <QScrollArea>
 #include <QVector>
 #include "documentsettings.h"
+#include "paginationmodel.h"
 class ScriptEditor;
+class ScreenplayDocumentLayout;
+class QPainter;
 
 class PageView : public QWidget {
     Q_OBJECT
 public:
-    struct ContinuationMarker {
-        int pageIndex = 0;
-        bool isTop = false;
-        QString text;
-    };
+    using ContinuationMarker = PaginationModel::ContinuationMarker;
 
     explicit PageView(QWidget *parent = nullptr);
     ScriptEditor* editor() const { return m_editor; }
     int pageGapPx() const { return PAGE_GAP_PX; }
     int pageCount() const { return m_pageCount; }
+    // Page metrics are in page units (unzoomed px); y offsets are in zoomed widget coordinates
     int printableHeight() const; // Height of printable area per page (px)
     int pageHeight() const { return m_pageRect.height(); } // Full page height including margins (px)
     int pageTopMarginPx() const { return m_printRect.top(); } // Top margin from page edge to printable area (px)
@@ -32,8 +35,10 @@ public:
     bool exportToPdf(const QString &filePath);
     const DocumentSettings &documentSettings() const { return m_documentSettings; }
     void setDocumentSettings(const DocumentSettings &settings) { m_documentSettings = settings; }
-    const QVector<ContinuationMarker> &continuationMarkers() const { return m_continuationMarkers; }
+    const QVector<ContinuationMarker> &continuationMarkers() const { return pagination().continuationMarkers(); }
+    const PaginationModel &pagination() const;
     int zoomSteps() const { return m_zoomSteps; }
+    double zoomFactor() const { return m_zoomFactor; }
     void setZoomSteps(int steps);
 
 signals:
@@ -58,8 +63,12 @@ private:
     void updatePagination();
     void recalculatePageMetrics();
     void applyZoom();
+    int toView(qreal pageUnits) const; // Page units to zoomed widget pixels
+    int pageX() const; // Left edge of the page column in the widget
     int pageYOffset(int pageIndex) const; // Y offset for page N with gaps
-    void enforcePageBreaks(); // Insert spacing at page boundaries
+    int pageAtY(int y) const; // Page whose top edge is at or above y, clamped to existing pages
+    QPixmap pageTile() const; // Cached paper, border and printable area for one page
+    void recordDebugOverlayPage(QPainter &p, int pageIndex) const;
     int printableHeightPerPage() const;
 
     // Page dimensions in inches (US Letter)
@@ -99,7 +108,6 @@ private:
     // Scroll behavior
     static constexpr int SCROLL_X_MARGIN = 40;
     static constexpr int SCROLL_Y_MARGIN = 120;
-    static constexpr double DEFAULT_BASE_FONT_POINT_SIZE = 12.0;
     static constexpr int MIN_ZOOM_STEPS = -8;
     static constexpr int MAX_ZOOM_STEPS = 20;
     static constexpr double ZOOM_STEP_MULTIPLIER = 1.1;
@@ -107,13 +115,16 @@ private:
     QRect m_pageRect;       // Single page size (8.5x11")
     QRect m_printRect;      // Printable area inside one page
     int m_pageCount = 1;    // Number of pages based on content
-    bool m_enforcingBreaks = false; // Guard against recursive calls
-    bool m_loading = false; // True during document load/initialization
     ScriptEditor* m_editor; // Editor placed inside printable area
+    ScreenplayDocumentLayout *m_documentLayout; // Places the editor's blocks on pages
+    QFont m_markerFont{QStringLiteral("Courier New"), 10}; // (MORE)/(CONT'D), built once rather than per paint
     bool m_debugMode = false;
+    struct DebugOverlayPage {
+        int generation = -1; // Pagination generation the picture was recorded for
+        QPicture picture;
+    };
+    QVector<DebugOverlayPage> m_debugOverlayPages; // Recorded lazily as pages are exposed
     int m_zoomSteps = 0;
     double m_zoomFactor = 1.0;
-    double m_baseFontPointSize = DEFAULT_BASE_FONT_POINT_SIZE;
     DocumentSettings m_documentSettings;
-    QVector<ContinuationMarker> m_continuationMarkers;
 };
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+class QTextDocument;
+
+// Page walk shared by the document layout, PageView, PdfExporter and the
+// debug overlay. Block heights and placements are cached by block number;
+// contentsChanged() marks the edited blocks dirty and update() re-walks only
+// from the last stable page boundary before them. The generation advances only
+// when a walk moves a page break or changes a block's extent, so an edit that
+// leaves the pages as they were keeps consumers' caches valid.
+//
+// Coordinates are document coordinates: y = 0 is the printable top of page 1
+// and page N's printable area starts at pageYOffset(N).
+class PaginationModel {
+public:
+    struct ContinuationMarker {
+        int pageIndex = 0;
+        bool isTop = false;
+        QString text;
+
+        bool operator==(const ContinuationMarker &other) const
+        {
+            return pageIndex == other.pageIndex && isTop == other.isTop && text == other.text;
+        }
+    };
+
+    // Breaks are ordered; breaks[i] starts page i + 1
+    struct PageBreak {
+        int blockNumber = 0; // Block at the top of the new page
+        int firstLine = 0;   // 0 when the whole block moved, else the first line continued on the page
+
+        bool operator==(const PageBreak &other) const
+        {
+            return blockNumber == other.blockNumber && firstLine == other.firstLine;
+        }
+    };
+
+    struct BlockRange {
+        int firstBlock = -1;
+        int lastBlock = -1;
+        bool isEmpty() const { return firstBlock < 0; }
+    };
+
+    void setPageMetrics(int pageHeight, int pageGap, int printableHeight);
+    void invalidate(int blockCount); // Mark every block dirty (font/zoom/width changes)
+    void contentsChanged(const QTextDocument *document, int position, int charsAdded);
+    bool needsUpdate(const QTextDocument *document) const;
+    BlockRange dirtyBlocks() const;
+
+    // Re-walks the dirty part of the document, reading heights from each block's
+    // QTextLayout. Returns the blocks whose placement was recomputed.
+    BlockRange update(const QTextDocument *document);
+
+    int generation() const { return m_generation; }
+    int blockCount() const { return m_blockExtents.size(); }
+    int pageCount() const { return m_pageBreaks.size() + 1; }
+    int pageAdvance() const { return m_pageHeight + m_pageGap; }
+    int printableHeight() const { return m_printableHeight; }
+    int pageYOffset(int pageIndex) const { return pageAdvance() * pageIndex; }
+    int pageForBlock(int blockNumber) const; // Page the block starts on
+    int firstBlockOfPage(int pageIndex) const;
+    int blockHeight(int blockNumber) const;      // Unsplit content height
+    int blockSpaceBefore(int blockNumber) const; // Element spacing above the block
+    int blockTop(int blockNumber) const;         // Content top in document coordinates
+    int blockRelativeY(int blockNumber) const;   // Content top below its page's printable top
+    QVector<int> blockSplitLines(int blockNumber) const; // Lines that start a new page
+    const QVector<PageBreak> &pageBreaks() const { return m_pageBreaks; }
+    const QVector<ContinuationMarker> &continuationMarkers() const { return m_continuationMarkers; }
+
+private:
+    struct BlockExtent {
+        int height = -1;      // Measured content height (px), -1 when dirty
+        int spaceBefore = 0;  // Block format top margin (px)
+        int relativeY = 0;    // Placement below the printable top of its first page
+    };
+
+    void markBlocksDirty(int firstBlock, int lastBlock);
+    void rebuildContinuationMarkers(const QTextDocument *document);
+
+    int m_pageHeight = 0;
+    int m_pageGap = 0;
+    int m_printableHeight = 0;
+    int m_generation = 0;
+    int m_dirtyFirstBlock = -1;
+    int m_dirtyLastBlock = -1;
+    QVector<BlockExtent> m_blockExtents;
+    QVector<PageBreak> m_pageBreaks;
+    QVector<ContinuationMarker> m_continuationMarkers;
+};
@@ -4,6 +4,7 @@
 #include "documentsettings.h"
 
 class QTextDocument;
+class PaginationModel;
 
 namespace PdfExporter {
 
@@ -13,6 +14,10 @@ struct Settings {
     int printableWidthPx = 0;
     int printableHeightPx = 0;
     int topMarginPx = 0;
+    int pageHeightPx = 0;
+
+    // Page breaks computed by the view; when null the exporter paginates the document itself
+    const PaginationModel *pagination = nullptr;
 
     double marginLeftInches = 1.5;
     double marginRightInches = 1.0;
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QAbstractTextDocumentLayout>
+#include <QSizeF>
+#include "paginationmodel.h"
+
+class QTextBlock;
+
+// Document layout that places blocks on stacked pages itself. Blocks that do
+// not fit move to the next page's printable top and blocks taller than the
+// space left are split by line, so pagination never touches block formats.
+//
+// blockBoundingRect() covers a block's lines only; its element spacing
+// (top margin) sits above the rect and is dropped at the top of a page.
+class ScreenplayDocumentLayout : public QAbstractTextDocumentLayout {
+    Q_OBJECT
+public:
+    explicit ScreenplayDocumentLayout(QTextDocument *document);
+
+    void setPageMetrics(int pageHeight, int pageGap, int printableHeight);
+    const PaginationModel &pagination() const { return m_pagination; }
+
+    void draw(QPainter *painter, const PaintContext &context) override;
+    int hitTest(const QPointF &point, Qt::HitTestAccuracy accuracy) const override;
+    int pageCount() const override;
+    QSizeF documentSize() const override;
+    QRectF frameBoundingRect(QTextFrame *frame) const override;
+    QRectF blockBoundingRect(const QTextBlock &block) const override;
+
+signals:
+    void paginationChanged();
+
+protected:
+    void documentChanged(int from, int charsRemoved, int charsAdded) override;
+
+private:
+    void relayout();
+    void layoutBlockText(const QTextBlock &block);
+    void positionBlockLines(const QTextBlock &block, int blockNumber);
+    int blockNumberAtY(qreal y) const;
+    qreal textWidth() const;
+
+    PaginationModel m_pagination;
+    QSizeF m_documentSize;
+};
@@ -3,16 +3,29 @@
 #include <QFont>
 #include <QScreen>
 #include <QGuiApplication>
-#include <QUndoStack>
 #include <QTextCursor>
 #include <QVector>
+#include <QBasicTimer>
+#include <QHash>
+#include <QSet>
+#include <QThreadPool>
+#include <QTextBlockFormat>
+#include <QTextCharFormat>
+#include "highlightlayer.h"
 #include "spellcheckservice.h"
+#include "undohistory.h"
+#include <array>
+#include <atomic>
 #include <memory>
 
 class QCompleter;
 class QStringListModel;
 class QContextMenuEvent;
 class QTimer;
+class QMouseEvent;
+class QPaintEvent;
+class QTextBlock;
+class QTextBlockUserData;
 
 class ScriptEditor : public QTextEdit {
     Q_OBJECT
@@ -36,7 +49,31 @@ public:
         Other
     };
 
+    // What one edit transaction changed: the affected span in post-edit positions (start
+    // is -1 when only the cursor moved), and where the cursor ended up
+    struct EditRecord {
+        int start = -1;
+        int end = -1;
+        int cursorPosition = 0;
+        ElementType element = Action;
+    };
+
+    // Groups edits so listeners hear about them once. While the outermost transaction is
+    // open the document edits share one edit block and cursor moves and element changes
+    // wait; when it ends the editor emits one cursorPositionChanged() and editCommitted().
+    class EditTransaction {
+    public:
+        explicit EditTransaction(ScriptEditor *editor);
+        ~EditTransaction();
+        EditTransaction(const EditTransaction &) = delete;
+        EditTransaction &operator=(const EditTransaction &) = delete;
+
+    private:
+        ScriptEditor *m_editor;
+    };
+
     explicit ScriptEditor(QWidget *parent = nullptr);
+    ~ScriptEditor() override;
     
     void applyFormat(ElementType type);
     void formatDocument(); // Apply formatting to all blocks based on their userState
@@ -50,8 +87,28 @@ public:
     bool spellcheckEnabled() const;
     int spellcheckMisspellingCount() const;
     QStringList spellcheckSuggestions(const QString &word) const;
+    const HighlightLayer &highlightLayer() const { return m_highlights; }
+    bool inEditTransaction() const { return m_transactionDepth > 0; }
+    // Moves the cursor now, or when the open transaction ends
+    void placeCursor(const QTextCursor &cursor);
+    // Bytes the undo history holds, commands and checkpoints together
+    qsizetype undoMemoryUsage() const { return m_undoHistory.memoryUsage(); }
+    // Checkpointed states restoreHistoryPoint() loads without replaying the whole history
+    QVector<UndoHistory::HistoryPoint> historyPoints() const { return m_undoHistory.historyPoints(); }
+    // Jumps to the state after index commands in one relayout, keeping redo available
+    bool restoreHistoryPoint(int index);
+    // Saves word to the user dictionary and clears just its highlights
+    void addWordToDictionary(const QString &word);
+    // Swaps the checker and rechecks the whole script; block results from the old one are dropped
+    void setSpellChecker(std::unique_ptr<AbstractSpellChecker> checker);
     bool replaceCurrent(const QString &replacement);
     int  replaceAll(const QString &replacement);
+    // View zoom: text stays laid out in page units and is painted through a scale transform
+    void setZoomFactor(qreal factor);
+    qreal zoomFactor() const { return m_zoomFactor; }
+    QRect viewCursorRect() const; // cursorRect() mapped into zoomed viewport coordinates
+    using QTextEdit::inputMethodQuery;
+    QVariant inputMethodQuery(Qt::InputMethodQuery query) const override;
 
 
 public slots:
@@ -65,13 +122,31 @@ public slots:
 protected:
     void keyPressEvent(QKeyEvent *e) override;
     void mousePressEvent(QMouseEvent *e) override;
+    void mouseMoveEvent(QMouseEvent *e) override;
+    void mouseReleaseEvent(QMouseEvent *e) override;
+    void mouseDoubleClickEvent(QMouseEvent *e) override;
+    void paintEvent(QPaintEvent *e) override;
+    void timerEvent(QTimerEvent *e) override;
+    void focusInEvent(QFocusEvent *e) override;
     void focusOutEvent(QFocusEvent *e) override;
+    void changeEvent(QEvent *e) override;
     void contextMenuEvent(QContextMenuEvent *event) override;
 
 private:
-    struct Range {
-        int start = 0;
-        int length = 0;
+    using Range = HighlightLayer::Range;
+
+    struct ElementFormats {
+        QTextBlockFormat block;
+        QTextCharFormat chars;
+    };
+
+    // One block of a spellcheck pass, snapshotted on the GUI thread
+    struct SpellBlock {
+        int position = 0;
+        QString text;
+        size_t textHash = 0;
+        bool cached = false;
+        QVector<Range> misspellings; // Relative to the block start
     };
 
     ElementType nextType(ElementType t) const;
@@ -79,6 +154,7 @@ private:
     ElementType currentElement() const;
     double dpiX() const;
     double inchToPx(double inches) const;
+    void watchPrimaryScreen(QScreen *screen);
     QStringList collectCharacterNames() const;
     QStringList sceneHeadingCompletions() const;
     QStringList completionCandidates(ElementType type, const QString &prefix) const;
@@ -86,23 +162,52 @@ private:
     void hideCompletionPopup();
     void insertChosenCompletion(const QString &completion);
     QString resolveInlineCompletion(ElementType type, const QString &prefix) const;
-    QTextDocument::FindFlags currentFindFlags() const;
     void rebuildFindMatches();
+    void updateHighlightRanges(int position, int charsRemoved, int charsAdded);
+    void appendBlockMatches(const QTextBlock &block, const QString &needle, QVector<Range> &matches) const;
     void applyFindMatchAtIndex(int index);
     void refreshSpellcheck();
     void scheduleSpellcheckRefresh();
+    void applySpellcheckChunk(int generation, const QVector<SpellBlock> &chunk, bool last);
+    void cancelSpellcheckPass();
+    void markSpellcheckDirty(int start, int end);
+    void beginEditTransaction();
+    void endEditTransaction();
+    void recordTransactionChange(int position, int charsRemoved, int charsAdded);
+    void pushCommand(QUndoCommand *command);
+    QByteArray captureHistorySnapshot() const;
+    void restoreHistorySnapshot(const QByteArray &snapshot);
     QString wordUnderCursor(QTextCursor *wordCursor = nullptr) const;
     void replaceRangeText(int start, int length, const QString &replacement);
-    void refreshExtraSelections();
+    void refreshHighlights();
+    QMouseEvent toPageUnits(const QMouseEvent *e) const;
+    void restartCaretBlink();
+    void updateZoomedViewport();
 
     UndoGroupType classifyChar(QChar ch) const;
     bool isNavigationKey(QKeyEvent *e) const;
     void applyFormatDirect(ElementType type);
     void buildFormats(ElementType type, QTextBlockFormat &bf, QTextCharFormat &cf) const;
+    const ElementFormats &elementFormats(ElementType type) const;
+    ElementFormats computeFormats(ElementType type) const;
+    void invalidateFormatCache() { m_formatCacheValid = false; }
 
-    QUndoStack m_undoStack;
+    UndoHistory m_undoHistory;
     bool m_suppressUndo = false;
+    int m_transactionDepth = 0;
+    QTextCursor m_transactionEditBlock; // Holds the document's edit block open
+    QTextCursor m_transactionCursor; // Deferred placeCursor(), null when none
+    EditRecord m_transactionRecord;
     int m_zoomSteps = 0;
+    qreal m_zoomFactor = 1.0;
+    // One entry per element for the current font and DPI. View zoom is a paint transform
+    // and font zoom is a font change, so those two are the whole key.
+    mutable std::array<ElementFormats, ElementCount> m_formatCache;
+    mutable bool m_formatCacheValid = false;
+    double m_dpiX = 96.0; // Primary screen's, kept current by watchPrimaryScreen()
+    QMetaObject::Connection m_screenDpiConnection;
+    QBasicTimer m_caretBlinkTimer;
+    bool m_caretVisible = true;
     QCompleter *m_completer = nullptr;
     QStringListModel *m_completionModel = nullptr;
     QString m_completionPrefix;
@@ -110,11 +215,20 @@ private:
     QString m_findQuery;
     bool m_findCaseSensitive = false;
     bool m_findWholeWord = false;
-    QVector<Range> m_findMatches;
+    HighlightLayer m_highlights;
+    // Both lists live in m_highlights so edits update them in place
+    QVector<Range> &m_findMatches = m_highlights.mutableRanges(HighlightLayer::FindMatch); // Sorted by start, never overlapping
     int m_activeFindIndex = -1;
     bool m_spellcheckEnabled = true;
     std::unique_ptr<AbstractSpellChecker> m_spellChecker;
-    QVector<Range> m_spellingRanges;
+    QVector<Range> &m_spellingRanges = m_highlights.mutableRanges(HighlightLayer::Spelling); // Sorted by start
+    QHash<QString, QSet<QTextBlockUserData *>> m_spellWordIndex; // Misspelled word to the cached blocks holding it
+    int m_spellDirtyStart = -1; // Span edited since the last pass, -1 when clean
+    int m_spellDirtyEnd = -1;
+    int m_spellPendingStart = -1; // Span a background pass has yet to deliver, -1 when idle
+    int m_spellPendingEnd = -1;
+    std::atomic<int> m_spellGeneration{0}; // Bumped to discard and stop the pass in flight
+    QThreadPool m_spellPool;
     QTimer *m_spellcheckTimer = nullptr;
 
 signals:
@@ -122,4 +236,7 @@ signals:
     void findResultsChanged(int activeIndex, int totalMatches);
     void undoAvailableChanged(bool canUndo);
     void redoAvailableChanged(bool canRedo);
+    void editCommitted(const ScriptEditor::EditRecord &record);
 };
+
+Q_DECLARE_METATYPE(ScriptEditor::EditRecord)
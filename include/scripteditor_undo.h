@@ -1,8 +1,10 @@
 #pragma once
 
 #include "scripteditor.h"
+#include "undohistory.h"
 #include <QString>
 #include <QUndoCommand>
+#include <QVector>
 #include <QTextBlockFormat>
 #include <QTextCharFormat>
 
@@ -13,9 +15,12 @@ QString normalizeSelectedText(const QString &text);
 class CompoundCommand : public QUndoCommand {
 public:
     explicit CompoundCommand(const QString &text = QString());
+
+    void redo() override;
+    void undo() override;
 };
 
-class InsertTextCommand : public QUndoCommand {
+class InsertTextCommand : public SizedUndoCommand {
 public:
     InsertTextCommand(ScriptEditor *editor, int pos, const QString &text,
                       ScriptEditor::UndoGroupType type, bool allowMerge,
@@ -25,6 +30,7 @@ public:
     bool mergeWith(const QUndoCommand *other) override;
     void redo() override;
     void undo() override;
+    qsizetype memoryCost() const override;
 
 private:
     ScriptEditor *m_editor;
@@ -34,7 +40,7 @@ private:
     bool m_allowMerge;
 };
 
-class DeleteTextCommand : public QUndoCommand {
+class DeleteTextCommand : public SizedUndoCommand {
 public:
     DeleteTextCommand(ScriptEditor *editor, int pos, const QString &text,
                       ScriptEditor::UndoGroupType type, bool allowMerge,
@@ -44,6 +50,7 @@ public:
     bool mergeWith(const QUndoCommand *other) override;
     void redo() override;
     void undo() override;
+    qsizetype memoryCost() const override;
 
 private:
     ScriptEditor *m_editor;
@@ -54,13 +61,41 @@ private:
     bool m_backspace;
 };
 
-class FormatCommand : public QUndoCommand {
+// Replaces every match in one document edit block, so layout, pagination, find and
+// spellcheck see a single change. Keeps each match's offset and length plus the
+// matched texts back to back, rather than a delete and an insert command per match.
+class ReplaceAllCommand : public SizedUndoCommand {
+public:
+    struct Span {
+        int start = 0; // Before any replacement
+        int length = 0;
+    };
+
+    // spans must be sorted and non-overlapping
+    ReplaceAllCommand(ScriptEditor *editor, const QVector<Span> &spans, const QString &replacement,
+                      QUndoCommand *parent = nullptr);
+
+    void redo() override;
+    void undo() override;
+    qsizetype memoryCost() const override;
+
+private:
+    ScriptEditor *m_editor;
+    QVector<Span> m_spans;
+    QString m_originals;
+    QString m_replacement;
+};
+
+class FormatCommand : public SizedUndoCommand {
 public:
     FormatCommand(ScriptEditor *editor, int blockPos, const QTextBlockFormat &newBlock,
                   const QTextCharFormat &newChar, int newState, QUndoCommand *parent = nullptr);
 
     void redo() override;
     void undo() override;
+    // Formats are implicitly shared with the document's and the editor's element formats,
+    // so only the text counts
+    qsizetype memoryCost() const override;
 
 private:
     void apply(const QTextBlockFormat &bf, const QTextCharFormat &cf, int state);
@@ -1,17 +1,28 @@
 #pragma once
 
+#include <QCache>
 #include <QList>
-#include <QSet>
+#include <QMutex>
 #include <QString>
 #include <QStringList>
+#include <QStringView>
+#include <functional>
 
+#include "suggestionindex.h"
+#include "userdictionary.h"
+
+// Detection only: suggestions are costly and computed on demand with suggestionsFor()
 struct Misspelling {
     int start = 0;
     int length = 0;
     QString word;
-    QStringList suggestions;
 };
 
+// Splits text into words the way the built-in checkers do (ASCII letters with inner
+// apostrophes) and returns the ones isKnown rejects. Words of two letters or fewer and
+// all-caps words are never flagged; isKnown sees the rest lower-cased in a scratch buffer.
+QList<Misspelling> findUnknownWords(QStringView text, const std::function<bool(QStringView)> &isKnown);
+
 class AbstractSpellChecker {
 public:
     virtual ~AbstractSpellChecker() = default;
@@ -19,21 +30,27 @@ public:
     virtual QList<Misspelling> checkText(const QString &text) const = 0;
     virtual QStringList suggestionsFor(const QString &word) const = 0;
     virtual void addWord(const QString &word) = 0;
+    // True when checkText() may run on a worker thread while the GUI thread keeps using the checker
+    virtual bool supportsBackgroundChecks() const { return false; }
 };
 
 class BasicSpellChecker final : public AbstractSpellChecker {
 public:
-    BasicSpellChecker();
+    // Words added with addWord() are saved to userDictionaryPath when one is given
+    explicit BasicSpellChecker(const QString &userDictionaryPath = QString());
 
     bool isAvailable() const override { return true; }
     QList<Misspelling> checkText(const QString &text) const override;
     QStringList suggestionsFor(const QString &word) const override;
     void addWord(const QString &word) override;
+    bool supportsBackgroundChecks() const override { return true; }
 
 private:
-    bool isLikelyCorrectToken(const QString &word) const;
-    int editDistance(const QString &a, const QString &b) const;
+    bool isKnownWord(QStringView word) const;
 
-    QSet<QString> m_dictionary;
-    QSet<QString> m_userDictionary;
+    // The built-in words live in the generated BaseDictionary table, shared by every checker
+    UserDictionary m_userDictionary;
+    SuggestionIndex m_userSuggestionIndex; // Base words are indexed once for all checkers
+    mutable QCache<QString, QStringList> m_suggestionCache{256}; // Least recently used go first
+    mutable QMutex m_suggestionMutex;
 };
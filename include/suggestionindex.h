@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QMultiHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Spelling suggestion lookup by symmetric deletes (the SymSpell scheme). Every
+// word is indexed under each string its first kPrefixLength characters reduce
+// to with up to kMaxDistance deletions. A query generates the same deletes and
+// only words sharing one are ranked by true edit distance, so a lookup touches
+// a handful of candidates instead of the whole dictionary.
+//
+// Deletes are stored as 32-bit hashes; collisions only add candidates, which
+// the distance check then drops.
+class SuggestionIndex {
+public:
+    static constexpr int kMaxDistance = 2;
+    static constexpr int kPrefixLength = 7;
+
+    // Replaces the contents with words, indexed in one sorted pass
+    void build(const QStringList &words);
+    // Adds one word without re-sorting the bulk index
+    void addWord(const QString &word);
+    bool contains(const QString &word) const { return m_known.contains(word); }
+    int wordCount() const { return m_words.size(); }
+
+    // Words within kMaxDistance edits, closest first and alphabetical within a distance
+    QStringList suggestions(const QString &word, int maxResults) const;
+
+private:
+    struct Entry {
+        quint32 deleteHash = 0;
+        int wordId = 0;
+    };
+
+    static QVector<quint32> deleteHashes(const QString &word);
+
+    QVector<QString> m_words;
+    QSet<QString> m_known;
+    QVector<Entry> m_entries; // Sorted by deleteHash
+    QMultiHash<quint32, int> m_addedEntries;
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QStringView>
+
+// Word scanning over UTF-16 text that yields spans into the caller's string and never
+// allocates. Spellcheck, word counts and whole-word find all go through here so they
+// agree on what a word is. Runs of ASCII are classified eight units at a time with
+// SSE2 or NEON where available.
+namespace TextTokenizer {
+
+struct Token {
+    int start = 0;
+    int length = 0;
+};
+
+// Spellcheck words: an ASCII letter followed by ASCII letters and apostrophes
+class SpellingWords {
+public:
+    explicit SpellingWords(QStringView text) : m_text(text) {}
+    bool next(Token &token);
+
+private:
+    QStringView m_text;
+    int m_position = 0;
+};
+
+// Runs of non-whitespace, the words of a word count
+int countWords(QStringView text);
+
+// True when no letter or digit touches either end of [start, start + length)
+bool isWholeWord(QStringView text, int start, int length);
+
+} // namespace TextTokenizer
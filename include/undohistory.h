@@ -0,0 +1,102 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QUndoCommand>
+#include <QVector>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Commands that can say how much memory they hold, for UndoHistory's budget. Others
+// are charged their object size.
+class SizedUndoCommand : public QUndoCommand {
+public:
+    using QUndoCommand::QUndoCommand;
+    virtual qsizetype memoryCost() const = 0;
+};
+
+// Undo stack with a memory budget. It stores a compressed snapshot of the document
+// when history starts and then every kCheckpointInterval commands or
+// kCheckpointMinutes, whichever comes first, just before the next command that does
+// not merge. Once the commands and snapshots outgrow the budget, the commands before
+// the oldest usable checkpoint are deleted and that checkpoint becomes the floor of
+// the history. restoreTo() reaches any state by loading the nearest checkpoint and
+// redoing at most one interval of commands. Merging and the canUndo/canRedo signals
+// follow QUndoStack.
+class UndoHistory : public QObject {
+    Q_OBJECT
+public:
+    static constexpr qsizetype kDefaultMemoryBudget = 32 * 1024 * 1024;
+    static constexpr int kCheckpointInterval = 200;
+    static constexpr int kCheckpointMinutes = 5;
+
+    // A state restoreTo() can load directly
+    struct HistoryPoint {
+        int index = 0;
+        QDateTime time;
+    };
+
+    explicit UndoHistory(QObject *parent = nullptr);
+    ~UndoHistory() override;
+
+    // Serializes the document as it stands; checkpoints are taken only once this is set
+    void setCheckpointCapture(std::function<QByteArray()> capture);
+    // Replaces the document with a snapshot from the capture function
+    void setCheckpointRestore(std::function<void(const QByteArray &)> restore);
+    void setMemoryBudget(qsizetype bytes);
+    qsizetype memoryBudget() const { return m_memoryBudget; }
+    // Bytes held by the commands and the compressed checkpoints
+    qsizetype memoryUsage() const { return m_commandBytes + m_checkpointBytes; }
+
+    // Runs command's redo() and takes ownership of it
+    void push(QUndoCommand *command);
+    void undo();
+    void redo();
+    void clear();
+    bool canUndo() const { return m_index > m_base; }
+    bool canRedo() const { return m_index < m_base + int(m_commands.size()); }
+    int count() const { return int(m_commands.size()); }
+    int checkpointCount() const { return m_checkpoints.size(); }
+    // Commands applied, counting those compacted away; restoreTo() takes the same numbering
+    int index() const { return m_index; }
+    int floorIndex() const { return m_base; }
+    QVector<HistoryPoint> historyPoints() const;
+    // Moves to the state after index commands, false when it is no longer held
+    bool restoreTo(int index);
+
+signals:
+    void canUndoChanged(bool canUndo);
+    void canRedoChanged(bool canRedo);
+
+private:
+    struct Checkpoint {
+        int index = 0; // Commands applied when it was taken
+        QByteArray data; // qCompress()ed
+        QDateTime time;
+    };
+
+    static qsizetype commandCost(const QUndoCommand *command);
+
+    bool checkpointDue() const;
+    void takeCheckpoint();
+    void dropCheckpointsAfter(int index);
+    void compact();
+    void updateAvailability();
+
+    std::vector<std::unique_ptr<QUndoCommand>> m_commands; // From m_base on
+    QVector<qsizetype> m_commandCosts;
+    QVector<Checkpoint> m_checkpoints; // Sorted by index
+    std::function<QByteArray()> m_capture;
+    std::function<void(const QByteArray &)> m_restore;
+    QElapsedTimer m_sinceCheckpoint;
+    int m_base = 0; // Commands below this were compacted away
+    int m_index = 0; // Commands applied, counting compacted ones
+    qsizetype m_memoryBudget = kDefaultMemoryBudget;
+    qsizetype m_commandBytes = 0;
+    qsizetype m_checkpointBytes = 0;
+    bool m_canUndo = false; // As last announced
+    bool m_canRedo = false;
+};
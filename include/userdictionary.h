@@ -0,0 +1,37 @@
+#pragma once
+
+#include <QFile>
+#include <QReadWriteLock>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+
+// Words the user added to the dictionary, kept across sessions in a plain file with
+// one word per line. Adding a word appends a single line, so the file is never
+// rewritten. Lookups may come from a background spellcheck while the GUI thread adds.
+class UserDictionary {
+public:
+    // An empty path keeps the words in memory only
+    explicit UserDictionary(const QString &path = QString());
+    UserDictionary(const UserDictionary &) = delete;
+    UserDictionary &operator=(const UserDictionary &) = delete;
+
+    // user_dictionary.txt in the application data directory
+    static QString defaultPath();
+
+    // word must already be lower-case
+    bool contains(QStringView word) const;
+    // False when the word is empty or already present
+    bool add(const QString &word);
+    QStringList words() const;
+    QString path() const { return m_path; }
+
+private:
+    // Position of word in m_words, or where it would be inserted
+    QStringList::const_iterator lowerBound(QStringView word) const;
+
+    QString m_path;
+    QStringList m_words; // Sorted, so a QStringView looks up without building a QString
+    mutable QReadWriteLock m_lock;
+    QFile m_file; // Opened for appending on the first add
+};
@@ -0,0 +1,62 @@
+#include "basedictionary.h"
+
+#include "basedictionary_table.h"
+
+namespace {
+
+constexpr bool slotMatches(const char *entry, QStringView word)
+{
+    if (!entry) {
+        return false;
+    }
+    qsizetype i = 0;
+    for (; i < word.size(); ++i) {
+        if (entry[i] == '\0' || char16_t(static_cast<unsigned char>(entry[i])) != word[i].unicode()) {
+            return false;
+        }
+    }
+    return entry[i] == '\0';
+}
+
+// Two-level lookup: the word's bucket holds the basis that sends it to its own slot
+constexpr bool tableContains(QStringView word)
+{
+    using namespace BaseDictionaryTable;
+    if (word.isEmpty()) {
+        return false;
+    }
+    const quint32 bucket = BaseDictionary::hash(word, kBucketBasis) % kDisplacements.size();
+    const quint32 slot = BaseDictionary::hash(word, kDisplacements[bucket]) % kSlots.size();
+    return slotMatches(kSlots[slot], word);
+}
+
+static_assert(tableContains(u"screenplay") && tableContains(u"int") && !tableContains(u"screenplays"),
+              "base dictionary table does not match its hash");
+
+} // namespace
+
+namespace BaseDictionary {
+
+bool contains(QStringView word)
+{
+    return tableContains(word);
+}
+
+int size()
+{
+    return BaseDictionaryTable::kWordCount;
+}
+
+QStringList words()
+{
+    QStringList result;
+    result.reserve(BaseDictionaryTable::kWordCount);
+    for (const char *entry : BaseDictionaryTable::kSlots) {
+        if (entry) {
+            result.append(QString::fromLatin1(entry));
+        }
+    }
+    return result;
+}
+
+} // namespace BaseDictionary
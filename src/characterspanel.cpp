@@ -1,5 +1,6 @@
 #include "characterspanel.h"
 
+#include "latencytrace.h"
 #include "scripteditor.h"
 
 #include <QFrame>
@@ -72,6 +73,7 @@ void CharactersPanel::setEditor(ScriptEditor *editor)
 
 void CharactersPanel::refreshCharacters()
 {
+    LatencyTrace::Scope trace(LatencyTrace::CharactersRefresh);
     m_characterList->clear();
 
     if (!m_editor) {
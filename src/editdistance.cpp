@@ -0,0 +1,156 @@
+#include "editdistance.h"
+
+#include <QVector>
+#include <QtGlobal>
+#include <algorithm>
+#include <array>
+
+namespace {
+
+// Match masks of a pattern: bit i of mask(c) is set where pattern[i] == c. ASCII has
+// a direct table; the few other characters a word holds are searched linearly.
+class PatternMasks {
+public:
+    explicit PatternMasks(QStringView pattern)
+    {
+        m_ascii.fill(0);
+        for (int i = 0; i < pattern.size(); ++i) {
+            const char16_t ch = pattern[i].unicode();
+            const quint64 bit = quint64(1) << i;
+            if (ch < m_ascii.size()) {
+                m_ascii[ch] |= bit;
+                continue;
+            }
+            int slot = 0;
+            while (slot < m_otherCount && m_otherChars[slot] != ch) {
+                ++slot;
+            }
+            if (slot == m_otherCount) {
+                m_otherChars[slot] = ch;
+                m_otherMasks[slot] = 0;
+                ++m_otherCount;
+            }
+            m_otherMasks[slot] |= bit;
+        }
+    }
+
+    quint64 mask(char16_t ch) const
+    {
+        if (ch < m_ascii.size()) {
+            return m_ascii[ch];
+        }
+        for (int slot = 0; slot < m_otherCount; ++slot) {
+            if (m_otherChars[slot] == ch) {
+                return m_otherMasks[slot];
+            }
+        }
+        return 0;
+    }
+
+private:
+    std::array<quint64, 128> m_ascii;
+    std::array<char16_t, EditDistance::kMaxBitParallelLength> m_otherChars;
+    std::array<quint64, EditDistance::kMaxBitParallelLength> m_otherMasks;
+    int m_otherCount = 0;
+};
+
+// Tracks the last row of the DP matrix column by column as vertical deltas packed in
+// Pv/Mv (+1/-1 per row). maxDistance < 0 disables the early exit.
+int myers(QStringView pattern, QStringView text, int maxDistance)
+{
+    const int m = pattern.size();
+    const int n = text.size();
+    if (m == 0) {
+        return n;
+    }
+
+    const PatternMasks masks(pattern);
+    const quint64 lastRow = quint64(1) << (m - 1);
+    quint64 pv = ~quint64(0);
+    quint64 mv = 0;
+    int score = m;
+
+    for (int j = 0; j < n; ++j) {
+        const quint64 eq = masks.mask(text[j].unicode());
+        const quint64 xv = eq | mv;
+        const quint64 xh = (((eq & pv) + pv) ^ pv) | eq;
+        quint64 ph = mv | ~(xh | pv);
+        quint64 mh = pv & xh;
+        if (ph & lastRow) {
+            ++score;
+        } else if (mh & lastRow) {
+            --score;
+        }
+        // Row 0 grows by one per column for a global distance, hence the carried-in 1
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+
+        // Each remaining column can lower the last row by at most one
+        if (maxDistance >= 0 && score - (n - 1 - j) > maxDistance) {
+            return maxDistance + 1;
+        }
+    }
+    return score;
+}
+
+} // namespace
+
+namespace EditDistance {
+
+int levenshtein(QStringView a, QStringView b)
+{
+    const int n = a.size();
+    const int m = b.size();
+
+    QVector<int> prev(m + 1);
+    QVector<int> curr(m + 1);
+
+    for (int j = 0; j <= m; ++j) {
+        prev[j] = j;
+    }
+
+    for (int i = 1; i <= n; ++i) {
+        curr[0] = i;
+        for (int j = 1; j <= m; ++j) {
+            const int cost = (a[i - 1] == b[j - 1]) ? 0 : 1;
+            curr[j] = std::min({
+                prev[j] + 1,
+                curr[j - 1] + 1,
+                prev[j - 1] + cost
+            });
+        }
+        prev = curr;
+    }
+
+    return prev[m];
+}
+
+int bitParallel(QStringView a, QStringView b)
+{
+    // Distance is symmetric; the shorter word becomes the bit-packed pattern
+    if (a.size() > b.size()) {
+        std::swap(a, b);
+    }
+    if (a.size() > kMaxBitParallelLength) {
+        return levenshtein(a, b);
+    }
+    return myers(a, b, -1);
+}
+
+int bounded(QStringView a, QStringView b, int maxDistance)
+{
+    if (qAbs(a.size() - b.size()) > maxDistance) {
+        return maxDistance + 1;
+    }
+    if (a.size() > b.size()) {
+        std::swap(a, b);
+    }
+    if (a.size() > kMaxBitParallelLength) {
+        return qMin(levenshtein(a, b), maxDistance + 1);
+    }
+    return qMin(myers(a, b, maxDistance), maxDistance + 1);
+}
+
+} // namespace EditDistance
@@ -0,0 +1,52 @@
+#include "highlightlayer.h"
+
+#include <QTextCursor>
+#include <QTextDocument>
+#include <algorithm>
+
+void HighlightLayer::setFormat(Kind kind, const QTextCharFormat &format, const QTextCharFormat &activeFormat)
+{
+    m_layers[kind].format = format;
+    m_layers[kind].activeFormat = activeFormat.isValid() ? activeFormat : format;
+}
+
+void HighlightLayer::setRanges(Kind kind, const QVector<Range> &ranges, int activeIndex)
+{
+    // Implicitly shared: no copy until one side changes
+    m_layers[kind].ranges = ranges;
+    m_layers[kind].activeIndex = activeIndex;
+}
+
+int HighlightLayer::removeEditedRanges(QVector<Range> &ranges, int start, int oldEnd, int delta)
+{
+    auto byStart = [](const Range &range, int pos) { return range.start < pos; };
+    const auto eraseBegin = std::lower_bound(ranges.begin(), ranges.end(), start, byStart);
+    const auto eraseEnd = std::lower_bound(eraseBegin, ranges.end(), oldEnd, byStart);
+    for (auto it = eraseEnd; it != ranges.end(); ++it) {
+        it->start += delta;
+    }
+    const int insertIndex = static_cast<int>(eraseBegin - ranges.begin());
+    ranges.erase(eraseBegin, eraseEnd);
+    return insertIndex;
+}
+
+void HighlightLayer::appendSelections(QTextDocument *document, int from, int to,
+                                      QVector<QAbstractTextDocumentLayout::Selection> &selections) const
+{
+    const int documentEnd = document->characterCount() - 1;
+    to = qMin(to, documentEnd);
+    for (const Layer &layer : m_layers) {
+        // Non-overlapping ranges sorted by start are sorted by end too
+        auto it = std::lower_bound(layer.ranges.cbegin(), layer.ranges.cend(), from,
+                                   [](const Range &range, int pos) { return range.start + range.length <= pos; });
+        for (; it != layer.ranges.cend() && it->start < to; ++it) {
+            QAbstractTextDocumentLayout::Selection selection;
+            selection.cursor = QTextCursor(document);
+            selection.cursor.setPosition(it->start);
+            selection.cursor.setPosition(it->start + it->length, QTextCursor::KeepAnchor);
+            const bool active = (it - layer.ranges.cbegin()) == layer.activeIndex;
+            selection.format = active ? layer.activeFormat : layer.format;
+            selections.append(selection);
+        }
+    }
+}
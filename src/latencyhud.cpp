@@ -0,0 +1,116 @@
+#include "latencyhud.h"
+
+#include "latencytrace.h"
+
+#include <QFont>
+#include <QFrame>
+#include <QLabel>
+#include <QPushButton>
+#include <QSizePolicy>
+#include <QTimer>
+#include <QVBoxLayout>
+
+namespace {
+constexpr int kRefreshIntervalMs = 500;
+
+QString formatUs(double us)
+{
+    if (us >= 1000.0) {
+        return QString::number(us / 1000.0, 'f', 1) + "ms";
+    }
+    return QString::number(us, 'f', 0) + "us";
+}
+}
+
+LatencyHud::LatencyHud(QWidget *parent)
+    : QWidget(parent)
+{
+    setObjectName("latencyHud");
+    setMinimumWidth(240);
+    setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Expanding);
+
+    auto *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->setSpacing(0);
+
+    auto *header = new QLabel("LATENCY", this);
+    header->setObjectName("panelSectionHeader");
+    layout->addWidget(header);
+
+    auto *divider = new QFrame(this);
+    divider->setObjectName("panelDivider");
+    divider->setFixedHeight(1);
+    layout->addWidget(divider);
+
+    m_traceLabel = new QLabel(this);
+    m_traceLabel->setObjectName("panelMeta");
+    m_traceLabel->setWordWrap(true);
+    layout->addWidget(m_traceLabel);
+
+    m_table = new QLabel(this);
+    m_table->setTextFormat(Qt::PlainText);
+    m_table->setAlignment(Qt::AlignTop | Qt::AlignLeft);
+    m_table->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    m_table->setContentsMargins(12, 6, 12, 6);
+    QFont tableFont("Courier New", 9);
+    tableFont.setStyleHint(QFont::TypeWriter);
+    m_table->setFont(tableFont);
+    layout->addWidget(m_table, 1);
+
+    auto *resetButton = new QPushButton("Reset", this);
+    resetButton->setObjectName("sidebarItem");
+    layout->addWidget(resetButton);
+    connect(resetButton, &QPushButton::clicked, this, &LatencyHud::resetStats);
+
+    // Only poll while the dock is visible
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(kRefreshIntervalMs);
+    connect(m_refreshTimer, &QTimer::timeout, this, &LatencyHud::refreshStats);
+
+    refreshStats();
+}
+
+void LatencyHud::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    refreshStats();
+    m_refreshTimer->start();
+}
+
+void LatencyHud::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    m_refreshTimer->stop();
+}
+
+void LatencyHud::refreshStats()
+{
+    const LatencyTrace &trace = LatencyTrace::instance();
+    m_traceLabel->setText(trace.chromeTraceEnabled()
+                              ? QString("Tracing to %1").arg(trace.chromeTracePath())
+                              : QString("Set SCREENQT_TRACE_FILE to record a trace"));
+
+    QString text = QString("%1 %2 %3 %4 %5\n")
+                       .arg(QStringLiteral("stage"), -18)
+                       .arg(QStringLiteral("n"), 7)
+                       .arg(QStringLiteral("p50"), 7)
+                       .arg(QStringLiteral("p95"), 7)
+                       .arg(QStringLiteral("p99"), 7);
+    for (int i = 0; i < LatencyTrace::StageCount; ++i) {
+        const auto stage = static_cast<LatencyTrace::Stage>(i);
+        const LatencyTrace::StageStats stats = trace.stats(stage);
+        text += QString("%1 %2 %3 %4 %5\n")
+                    .arg(QString::fromLatin1(LatencyTrace::stageName(stage)), -18)
+                    .arg(stats.count, 7)
+                    .arg(formatUs(stats.p50Us), 7)
+                    .arg(formatUs(stats.p95Us), 7)
+                    .arg(formatUs(stats.p99Us), 7);
+    }
+    m_table->setText(text);
+}
+
+void LatencyHud::resetStats()
+{
+    LatencyTrace::instance().reset();
+    refreshStats();
+}
@@ -0,0 +1,173 @@
+#include "latencytrace.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QTextStream>
+#include <chrono>
+#include <cmath>
+
+namespace {
+constexpr const char *kTraceFileEnv = "SCREENQT_TRACE_FILE";
+
+void writeTraceAtExit()
+{
+    LatencyTrace &trace = LatencyTrace::instance();
+    if (trace.chromeTraceEnabled() && !trace.writeChromeTrace(trace.chromeTracePath())) {
+        qWarning() << "[LatencyTrace] Could not write trace to" << trace.chromeTracePath();
+    }
+}
+}
+
+LatencyTrace::Scope::Scope(Stage stage)
+    : m_stage(stage)
+{
+    LatencyTrace &trace = LatencyTrace::instance();
+    if (trace.m_depth[stage]++ == 0) {
+        m_startNs = trace.nowNs();
+    }
+}
+
+LatencyTrace::Scope::~Scope()
+{
+    LatencyTrace &trace = LatencyTrace::instance();
+    --trace.m_depth[m_stage];
+    if (m_startNs >= 0) {
+        trace.record(m_stage, m_startNs, trace.nowNs() - m_startNs);
+    }
+}
+
+LatencyTrace::LatencyTrace()
+{
+    m_epochNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    const QString tracePath = qEnvironmentVariable(kTraceFileEnv);
+    if (!tracePath.isEmpty()) {
+        setChromeTracePath(tracePath);
+        qAddPostRoutine(writeTraceAtExit);
+    }
+}
+
+LatencyTrace &LatencyTrace::instance()
+{
+    static LatencyTrace trace;
+    return trace;
+}
+
+const char *LatencyTrace::stageName(Stage stage)
+{
+    switch (stage) {
+    case KeyPress:          return "keyPress";
+    case UndoCommand:       return "undoCommand";
+    case Layout:            return "layout";
+    case FindMatches:       return "findMatches";
+    case Spellcheck:        return "spellcheck";
+    case OutlineRefresh:    return "outlineRefresh";
+    case CharactersRefresh: return "charactersRefresh";
+    case DirtyFlag:         return "dirtyFlag";
+    case StatusUpdate:      return "statusUpdate";
+    case StageCount:        break;
+    }
+    return "unknown";
+}
+
+qint64 LatencyTrace::nowNs() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count() - m_epochNs;
+}
+
+void LatencyTrace::record(Stage stage, qint64 startNs, qint64 durationNs)
+{
+    Histogram &histogram = m_histograms[stage];
+    ++histogram.buckets[bucketForNs(durationNs)];
+    ++histogram.count;
+    histogram.maxNs = qMax(histogram.maxNs, durationNs);
+
+    if (chromeTraceEnabled() && m_events.size() < kMaxTraceEvents) {
+        m_events.append(TraceEvent{startNs, durationNs, stage});
+    }
+}
+
+int LatencyTrace::bucketForNs(qint64 durationNs)
+{
+    // Bucket 0 holds everything under 1 us; bucket b >= 1 covers [2^((b-1)/4), 2^(b/4)) us
+    const double us = durationNs / 1000.0;
+    if (us < 1.0) {
+        return 0;
+    }
+    const int bucket = 1 + static_cast<int>(std::floor(std::log2(us) * kBucketsPerOctave));
+    return qMin(bucket, kBucketCount - 1);
+}
+
+double LatencyTrace::bucketUpperUs(int bucket)
+{
+    return std::exp2(static_cast<double>(bucket) / kBucketsPerOctave);
+}
+
+double LatencyTrace::percentileUs(const Histogram &histogram, double fraction) const
+{
+    if (histogram.count == 0) {
+        return 0;
+    }
+    // Upper edge of the bucket holding the sample at this rank, capped by the slowest sample
+    const qint64 rank = qMax<qint64>(1, static_cast<qint64>(std::ceil(fraction * histogram.count)));
+    qint64 seen = 0;
+    for (int bucket = 0; bucket < kBucketCount; ++bucket) {
+        seen += histogram.buckets[bucket];
+        if (seen >= rank) {
+            return qMin(bucketUpperUs(bucket), histogram.maxNs / 1000.0);
+        }
+    }
+    return histogram.maxNs / 1000.0;
+}
+
+LatencyTrace::StageStats LatencyTrace::stats(Stage stage) const
+{
+    const Histogram &histogram = m_histograms[stage];
+    StageStats result;
+    result.count = histogram.count;
+    result.p50Us = percentileUs(histogram, 0.50);
+    result.p95Us = percentileUs(histogram, 0.95);
+    result.p99Us = percentileUs(histogram, 0.99);
+    result.maxUs = histogram.maxNs / 1000.0;
+    return result;
+}
+
+void LatencyTrace::reset()
+{
+    m_histograms = {};
+    m_events.clear();
+}
+
+void LatencyTrace::setChromeTracePath(const QString &path)
+{
+    m_chromeTracePath = path;
+    if (path.isEmpty()) {
+        m_events.clear();
+    }
+}
+
+bool LatencyTrace::writeChromeTrace(const QString &path) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        return false;
+    }
+
+    // Complete ("X") events on one thread; timestamps are microseconds
+    QTextStream out(&file);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (int i = 0; i < m_events.size(); ++i) {
+        const TraceEvent &event = m_events.at(i);
+        out << (i == 0 ? "\n" : ",\n")
+            << "{\"name\":\"" << stageName(event.stage) << "\",\"cat\":\"screenqt\",\"ph\":\"X\""
+            << ",\"ts\":" << QString::number(event.startNs / 1000.0, 'f', 3)
+            << ",\"dur\":" << QString::number(event.durationNs / 1000.0, 'f', 3)
+            << ",\"pid\":1,\"tid\":1}";
+    }
+    out << "\n]}\n";
+    out.flush();
+    return out.status() == QTextStream::Ok;
+}
@@ -0,0 +1,161 @@
+#include "linegridpaginator.h"
+#include "scripteditor.h"
+#include <QTextBlock>
+#include <QTextDocument>
+#include <cmath>
+
+namespace {
+constexpr int kDialogueElementState = static_cast<int>(ScriptEditor::Dialogue);
+
+bool isBreakSpace(QChar ch)
+{
+    return ch == QLatin1Char(' ') || ch == QLatin1Char('\t') || ch == QChar::Nbsp;
+}
+}
+
+LineGridPaginator::LineGridPaginator(const Settings &settings)
+    : m_settings(settings)
+{
+    m_columns.resize(ScriptEditor::ElementCount + 1);
+    for (int type = 0; type <= ScriptEditor::ElementCount; ++type) {
+        const double width = elementGeometry(type).widthInches * m_settings.charactersPerInch;
+        m_columns[type] = qMax(1, static_cast<int>(std::floor(width + 1e-6)));
+    }
+}
+
+LineGridPaginator::ElementGeometry LineGridPaginator::elementGeometry(int elementType)
+{
+    switch (elementType) {
+    case ScriptEditor::SceneHeading:
+        return ElementGeometry{0.0, 6.0, 1};
+    case ScriptEditor::Action:
+        return ElementGeometry{0.0, 6.0, 1};
+    case ScriptEditor::CharacterName:
+        return ElementGeometry{2.3, 6.0 - 2.3, 1};
+    case ScriptEditor::Dialogue:
+        return ElementGeometry{1.0, 3.5, 0};
+    case ScriptEditor::Parenthetical:
+        return ElementGeometry{1.5, 2.5, 0};
+    case ScriptEditor::Shot:
+        return ElementGeometry{0.0, 6.0, 1};
+    case ScriptEditor::Transition:
+        return ElementGeometry{0.0, 6.0, 1};
+    default:
+        return ElementGeometry{};
+    }
+}
+
+int LineGridPaginator::wrappedLineCount(QStringView text, int columns)
+{
+    const int length = static_cast<int>(text.size());
+    if (length == 0 || columns <= 0) {
+        return 1;
+    }
+
+    int lines = 0;
+    int pos = 0;
+    while (pos < length) {
+        ++lines;
+        if (length - pos <= columns) {
+            break;
+        }
+
+        // Trailing spaces hang past the right edge, so a space right at the limit still breaks.
+        // Otherwise break after the last space or hyphen on the line, or hard-wrap a long word.
+        const int limit = pos + columns;
+        int next = -1;
+        for (int i = limit; i > pos; --i) {
+            const QChar ch = text.at(i);
+            if (isBreakSpace(ch)) {
+                next = i + 1;
+                break;
+            }
+            const QChar prev = text.at(i - 1);
+            if (prev == QLatin1Char('-') && i - 1 > pos && !isBreakSpace(text.at(i - 2))) {
+                next = i;
+                break;
+            }
+        }
+        if (next < 0) {
+            next = limit;
+        }
+        while (next < length && isBreakSpace(text.at(next))) {
+            ++next;
+        }
+        pos = next;
+    }
+    return lines;
+}
+
+int LineGridPaginator::columnsForElement(int elementType) const
+{
+    if (elementType < 0 || elementType >= ScriptEditor::ElementCount) {
+        return m_columns.at(ScriptEditor::ElementCount);
+    }
+    return m_columns.at(elementType);
+}
+
+int LineGridPaginator::blockLineCount(int elementType, QStringView text) const
+{
+    return wrappedLineCount(text, columnsForElement(elementType));
+}
+
+void LineGridPaginator::startPage(Walk &walk, int blockNumber, int elementType) const
+{
+    const int nextPageIndex = walk.result.pageCount;
+    walk.result.pageFirstBlocks.append(blockNumber);
+    ++walk.result.pageCount;
+    if (elementType == kDialogueElementState) {
+        walk.result.continuationMarkers.append(
+            PaginationModel::ContinuationMarker{nextPageIndex - 1, false, "(MORE)"});
+        walk.result.continuationMarkers.append(
+            PaginationModel::ContinuationMarker{nextPageIndex, true, "(CONT'D)"});
+    }
+    walk.linesOnPage = 0;
+}
+
+void LineGridPaginator::step(Walk &walk, int blockNumber, int elementType, QStringView text) const
+{
+    const int lines = blockLineCount(elementType, text);
+    const int spaceBefore = elementGeometry(elementType).spaceBeforeLines;
+    const int linesPerPage = m_settings.linesPerPage;
+
+    // Same rule as ScreenplayDocumentLayout: a block that does not fit below the lines already
+    // on the page starts the next one, and element spacing is dropped at the top of a page.
+    if (walk.linesOnPage > 0 && walk.linesOnPage + spaceBefore + lines > linesPerPage) {
+        startPage(walk, blockNumber, elementType);
+    }
+    const int top = walk.linesOnPage > 0 ? walk.linesOnPage + spaceBefore : 0;
+    walk.result.lineCount += (top - walk.linesOnPage) + lines;
+    walk.linesOnPage = top + lines;
+
+    // A block longer than a whole page continues on the following pages
+    while (walk.linesOnPage > linesPerPage) {
+        const int remaining = walk.linesOnPage - linesPerPage;
+        startPage(walk, blockNumber, elementType);
+        walk.linesOnPage = remaining;
+    }
+}
+
+LineGridPaginator::Result LineGridPaginator::paginate(const QVector<Block> &blocks) const
+{
+    Walk walk;
+    for (int i = 0; i < blocks.size(); ++i) {
+        step(walk, i, blocks.at(i).elementType, blocks.at(i).text);
+    }
+    return walk.result;
+}
+
+LineGridPaginator::Result LineGridPaginator::paginate(const QTextDocument *document) const
+{
+    Walk walk;
+    if (!document) {
+        return walk.result;
+    }
+    int blockNumber = 0;
+    for (QTextBlock block = document->begin(); block.isValid(); block = block.next(), ++blockNumber) {
+        const QString text = block.text();
+        step(walk, blockNumber, block.userState(), text);
+    }
+    return walk.result;
+}
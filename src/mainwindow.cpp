@@ -14,12 +14,13 @@
 #include <QFontInfo>
 #include <QFormLayout>
 #include <QHBoxLayout>
+#include <QInputDialog>
 #include <QLabel>
 #include <QMenu>
 #include <QMenuBar>
 #include <QMessageBox>
-#include <QRegularExpression>
 #include <QScrollArea>
+#include <QLocale>
 #include <QSettings>
 #include <QStackedWidget>
 #include <QStandardPaths>
@@ -34,11 +35,14 @@
 #include "elementtypepanel.h"
 #include "findbar.h"
 #include "fountainio.h"
+#include "latencyhud.h"
+#include "latencytrace.h"
 #include "outlinepanel.h"
 #include "pageview.h"
 #include "screenplayio.h"
 #include "scripteditor.h"
 #include "startscreen.h"
+#include "texttokenizer.h"
 #include "titlepage_dialog.h"
 
 // ---------------------------------------------------------------------------
@@ -348,6 +352,7 @@ MainWindow::MainWindow(QWidget *parent)
     m_elementDock->hide();
     m_outlineDock->hide();
     m_charactersDock->hide();
+    m_latencyDock->hide();
 
     m_stack->setCurrentWidget(m_startScreen);
 }
@@ -405,6 +410,9 @@ void MainWindow::setupMenus()
     m_redoAction->setShortcut(QKeySequence::Redo);
     m_redoAction->setEnabled(false);
 
+    m_restoreHistoryAction = editMenu->addAction("Restore &History Point...");
+    m_restoreHistoryAction->setEnabled(false);
+
     editMenu->addSeparator();
 
     m_findAction = editMenu->addAction("&Find...");
@@ -443,6 +451,11 @@ void MainWindow::setupMenus()
 
     m_resetLayoutAction = viewMenu->addAction("Reset &Layout");
 
+    viewMenu->addSeparator();
+
+    m_latencyHudAction = viewMenu->addAction("&Latency HUD");
+    m_latencyHudAction->setCheckable(true);
+
     // ── Tools menu ─────────────────────────────────────────────────────────
     QMenu *toolsMenu = bar->addMenu("&Tools");
 
@@ -557,6 +570,27 @@ void MainWindow::setupMenus()
     connect(m_redoAction, &QAction::triggered, this, [this] {
         if (m_currentPage) m_currentPage->editor()->redo();
     });
+    connect(m_restoreHistoryAction, &QAction::triggered, this, [this] {
+        if (!m_currentPage) return;
+        ScriptEditor *editor = m_currentPage->editor();
+        const QVector<UndoHistory::HistoryPoint> points = editor->historyPoints();
+        if (points.isEmpty()) {
+            QMessageBox::information(this, "Restore History Point", "No history points have been saved yet.");
+            return;
+        }
+        // Newest first; each entry is a checkpoint the editor can load without replaying
+        QStringList labels;
+        for (int i = points.size() - 1; i >= 0; --i) {
+            labels << QString("%1 (%2 edits)")
+                          .arg(QLocale().toString(points.at(i).time, QLocale::ShortFormat))
+                          .arg(points.at(i).index);
+        }
+        bool ok = false;
+        const QString choice = QInputDialog::getItem(this, "Restore History Point", "Restore the script as it was at:",
+                                                     labels, 0, false, &ok);
+        if (!ok) return;
+        editor->restoreHistoryPoint(points.at(points.size() - 1 - labels.indexOf(choice)).index);
+    });
 
     connect(m_findAction, &QAction::triggered, this, [this] {
         if (!m_currentFindBar) return;
@@ -627,6 +661,15 @@ void MainWindow::setupDocks()
     m_outlineDock->setMaximumWidth(UiSpacing::SidebarMaxWidth);
     m_charactersDock->setMinimumWidth(UiSpacing::SidebarMinWidth);
     m_charactersDock->setMaximumWidth(UiSpacing::SidebarMaxWidth);
+
+    // Typing latency HUD, shown from the View menu
+    m_latencyHud  = new LatencyHud();
+    m_latencyDock = new QDockWidget("LATENCY", this);
+    m_latencyDock->setFeatures(QDockWidget::DockWidgetMovable | QDockWidget::DockWidgetFloatable);
+    m_latencyDock->setWidget(m_latencyHud);
+    addDockWidget(Qt::LeftDockWidgetArea, m_latencyDock);
+    m_latencyDock->hide();
+    connect(m_latencyHudAction, &QAction::toggled, m_latencyDock, &QDockWidget::setVisible);
 }
 
 void MainWindow::setupConnections()
@@ -825,6 +868,7 @@ void MainWindow::updatePageStatus(int pageCount)
 
 void MainWindow::updateCursorStatus()
 {
+    LatencyTrace::Scope trace(LatencyTrace::StatusUpdate);
     if (!m_currentPage) return;
     ScriptEditor *ed = m_currentPage->editor();
     QTextDocument *doc = ed->document();
@@ -834,8 +878,6 @@ void MainWindow::updateCursorStatus()
     int sceneNum = 0;
     bool pastCursor = false;
 
-    static const QRegularExpression whitespace("\\s+");
-
     QTextBlock b = doc->begin();
     while (b.isValid()) {
         const int state = b.userState();
@@ -846,10 +888,7 @@ void MainWindow::updateCursorStatus()
             ++sceneNum;
         }
         if (state == ScriptEditor::Action || state == ScriptEditor::Dialogue) {
-            const QString text = b.text().trimmed();
-            if (!text.isEmpty()) {
-                wordCount += text.split(whitespace, Qt::SkipEmptyParts).count();
-            }
+            wordCount += TextTokenizer::countWords(b.text());
         }
         b = b.next();
     }
@@ -897,18 +936,13 @@ void MainWindow::showScriptStatistics()
     int wordCount  = 0;
     QSet<QString> characters;
 
-    static const QRegularExpression whitespace("\\s+");
-
     QTextBlock b = doc->begin();
     while (b.isValid()) {
         const int state = b.userState();
         if (state == ScriptEditor::SceneHeading) {
             ++sceneCount;
         } else if (state == ScriptEditor::Action || state == ScriptEditor::Dialogue) {
-            const QString text = b.text().trimmed();
-            if (!text.isEmpty()) {
-                wordCount += text.split(whitespace, Qt::SkipEmptyParts).count();
-            }
+            wordCount += TextTokenizer::countWords(b.text());
         } else if (state == ScriptEditor::CharacterName) {
             const QString name = b.text().trimmed();
             if (!name.isEmpty()) characters.insert(name);
@@ -958,6 +992,7 @@ void MainWindow::showScriptStatistics()
     addStat("Words",      QString::number(wordCount));
     addStat("Est. Runtime",
             runtimeMins == 1 ? "~1 min" : QString("~%1 min").arg(runtimeMins));
+    addStat("Undo History", QLocale().formattedDataSize(ed->undoMemoryUsage()));
 
     root->addSpacing(8);
 
@@ -1064,6 +1099,7 @@ void MainWindow::createPageView()
     m_exportFdxAction->setEnabled(true);
     m_exportFountainAction->setEnabled(true);
     m_exportPdfAction->setEnabled(true);
+    m_restoreHistoryAction->setEnabled(true);
     m_findAction->setEnabled(true);
     m_findNextAction->setEnabled(true);
     m_findPreviousAction->setEnabled(true);
@@ -1094,6 +1130,7 @@ void MainWindow::createPageView()
 // ---------------------------------------------------------------------------
 void MainWindow::setDirty(bool dirty)
 {
+    LatencyTrace::Scope trace(LatencyTrace::DirtyFlag);
     if (m_isDirty == dirty) return;
     m_isDirty = dirty;
     updateWindowTitle();
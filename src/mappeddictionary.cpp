@@ -0,0 +1,394 @@
+#include "mappeddictionary.h"
+
+#include <QPair>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QVarLengthArray>
+#include <QVector>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr char kMagic[8] = {'S', 'Q', 'T', 'D', 'A', 'W', 'G', '1'};
+constexpr quint32 kVersion = 1;
+constexpr qint64 kHeaderSize = sizeof(kMagic) + 5 * sizeof(quint32);
+constexpr qint64 kNodeSize = 8;
+constexpr qint64 kEdgeSize = 8;
+constexpr quint32 kTerminalBit = 0x80000000u;
+
+void setError(QString *error, const QString &message)
+{
+    if (error) {
+        *error = message;
+    }
+}
+
+void appendU16(QByteArray &out, quint16 value)
+{
+    const quint16 le = qToLittleEndian(value);
+    out.append(reinterpret_cast<const char *>(&le), sizeof(le));
+}
+
+void appendU32(QByteArray &out, quint32 value)
+{
+    const quint32 le = qToLittleEndian(value);
+    out.append(reinterpret_cast<const char *>(&le), sizeof(le));
+}
+
+// Builds a trie from sorted words, then merges identical subtrees bottom-up so every
+// distinct suffix structure is written once
+class DawgBuilder {
+public:
+    struct PackedNode {
+        bool terminal = false;
+        std::vector<std::pair<char16_t, quint32>> edges;
+    };
+
+    explicit DawgBuilder(const QStringList &sortedWords)
+    {
+        m_trie.emplace_back();
+        for (const QString &word : sortedWords) {
+            insert(word);
+        }
+        m_root = minimize(0);
+    }
+
+    const std::vector<PackedNode> &nodes() const { return m_packed; }
+    quint32 root() const { return m_root; }
+
+private:
+    struct TrieNode {
+        bool terminal = false;
+        std::vector<std::pair<char16_t, int>> children;
+    };
+
+    void insert(const QString &word)
+    {
+        int current = 0;
+        for (QChar ch : word) {
+            // Sorted input only ever extends the last child
+            std::vector<std::pair<char16_t, int>> &children = m_trie[current].children;
+            if (!children.empty() && children.back().first == ch.unicode()) {
+                current = children.back().second;
+                continue;
+            }
+            const int created = static_cast<int>(m_trie.size());
+            m_trie[current].children.emplace_back(ch.unicode(), created);
+            m_trie.emplace_back();
+            current = created;
+        }
+        m_trie[current].terminal = true;
+    }
+
+    quint32 minimize(int index)
+    {
+        PackedNode packed;
+        packed.terminal = m_trie[index].terminal;
+        for (const auto &child : m_trie[index].children) {
+            packed.edges.emplace_back(child.first, minimize(child.second));
+        }
+
+        std::vector<quint32> signature;
+        signature.reserve(1 + packed.edges.size() * 2);
+        signature.push_back(packed.terminal ? 1 : 0);
+        for (const auto &edge : packed.edges) {
+            signature.push_back(edge.first);
+            signature.push_back(edge.second);
+        }
+
+        const auto existing = m_canonical.find(signature);
+        if (existing != m_canonical.end()) {
+            return existing->second;
+        }
+        const quint32 id = static_cast<quint32>(m_packed.size());
+        m_packed.push_back(std::move(packed));
+        m_canonical.emplace(std::move(signature), id);
+        return id;
+    }
+
+    std::vector<TrieNode> m_trie;
+    std::vector<PackedNode> m_packed;
+    std::map<std::vector<quint32>, quint32> m_canonical;
+    quint32 m_root = 0;
+};
+
+} // namespace
+
+struct MappedDictionary::Search {
+    QStringView word;
+    int maxDistance = 0;
+    QString prefix;
+    QVector<QPair<QString, int>> results;
+};
+
+bool MappedDictionary::compile(const QStringList &words, const QString &path, QString *error)
+{
+    QStringList sorted;
+    sorted.reserve(words.size());
+    for (const QString &word : words) {
+        const QString normalized = word.trimmed().toLower();
+        if (!normalized.isEmpty()) {
+            sorted.append(normalized);
+        }
+    }
+    sorted.sort();
+    sorted.removeDuplicates();
+
+    const DawgBuilder builder(sorted);
+    const std::vector<DawgBuilder::PackedNode> &nodes = builder.nodes();
+    quint32 edgeCount = 0;
+    for (const DawgBuilder::PackedNode &node : nodes) {
+        edgeCount += static_cast<quint32>(node.edges.size());
+    }
+
+    QByteArray out;
+    out.reserve(static_cast<int>(kHeaderSize + nodes.size() * kNodeSize + edgeCount * kEdgeSize));
+    out.append(kMagic, sizeof(kMagic));
+    appendU32(out, kVersion);
+    appendU32(out, static_cast<quint32>(sorted.size()));
+    appendU32(out, static_cast<quint32>(nodes.size()));
+    appendU32(out, edgeCount);
+    appendU32(out, builder.root());
+
+    quint32 firstEdge = 0;
+    for (const DawgBuilder::PackedNode &node : nodes) {
+        appendU32(out, firstEdge);
+        appendU32(out, static_cast<quint32>(node.edges.size()) | (node.terminal ? kTerminalBit : 0));
+        firstEdge += static_cast<quint32>(node.edges.size());
+    }
+    for (const DawgBuilder::PackedNode &node : nodes) {
+        for (const auto &edge : node.edges) {
+            appendU16(out, edge.first);
+            appendU16(out, 0);
+            appendU32(out, edge.second);
+        }
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(out) != out.size() || !file.commit()) {
+        setError(error, QString("Cannot write %1: %2").arg(path, file.errorString()));
+        return false;
+    }
+    return true;
+}
+
+QStringList MappedDictionary::readWordList(const QString &path, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        setError(error, QString("Cannot read %1: %2").arg(path, file.errorString()));
+        return {};
+    }
+
+    QStringList words;
+    QTextStream in(&file);
+    bool firstLine = true;
+    while (!in.atEnd()) {
+        const QString line = in.readLine().trimmed();
+        // A Hunspell .dic starts with its entry count
+        if (firstLine) {
+            firstLine = false;
+            bool isCount = false;
+            line.toInt(&isCount);
+            if (isCount) {
+                continue;
+            }
+        }
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+
+        // Hunspell entries carry affix flags after '/' and optional tab-separated fields
+        qsizetype end = line.size();
+        for (qsizetype i = 0; i < line.size(); ++i) {
+            if (line.at(i) == '/' || line.at(i).isSpace()) {
+                end = i;
+                break;
+            }
+        }
+        if (end > 0) {
+            words.append(line.left(end));
+        }
+    }
+    return words;
+}
+
+bool MappedDictionary::open(const QString &path, QString *error)
+{
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_data = m_nodes = m_edges = nullptr;
+    m_wordCount = m_nodeCount = m_edgeCount = m_root = 0;
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        setError(error, QString("Cannot open %1: %2").arg(path, m_file.errorString()));
+        return false;
+    }
+
+    auto fail = [this, error, &path](const char *reason) {
+        setError(error, QString("%1 is not a dictionary file: %2").arg(path, QString::fromLatin1(reason)));
+        m_file.close();
+        return false;
+    };
+
+    const qint64 size = m_file.size();
+    if (size < kHeaderSize) {
+        return fail("too short");
+    }
+    const uchar *data = m_file.map(0, size);
+    if (!data) {
+        return fail("cannot be mapped");
+    }
+    if (std::memcmp(data, kMagic, sizeof(kMagic)) != 0) {
+        return fail("bad magic");
+    }
+
+    const uchar *fields = data + sizeof(kMagic);
+    if (qFromLittleEndian<quint32>(fields) != kVersion) {
+        return fail("unsupported version");
+    }
+    const quint32 wordCount = qFromLittleEndian<quint32>(fields + 4);
+    const quint32 nodeCount = qFromLittleEndian<quint32>(fields + 8);
+    const quint32 edgeCount = qFromLittleEndian<quint32>(fields + 12);
+    const quint32 root = qFromLittleEndian<quint32>(fields + 16);
+    if (nodeCount == 0 || root >= nodeCount
+        || size != kHeaderSize + qint64(nodeCount) * kNodeSize + qint64(edgeCount) * kEdgeSize) {
+        return fail("inconsistent sizes");
+    }
+
+    m_data = data;
+    m_nodes = data + kHeaderSize;
+    m_edges = m_nodes + qint64(nodeCount) * kNodeSize;
+    m_wordCount = wordCount;
+    m_nodeCount = nodeCount;
+    m_edgeCount = edgeCount;
+    m_root = root;
+    return true;
+}
+
+bool MappedDictionary::contains(QStringView word) const
+{
+    if (!m_data || word.isEmpty()) {
+        return false;
+    }
+    quint32 current = m_root;
+    for (QChar ch : word) {
+        if (!child(node(current), ch.unicode(), current)) {
+            return false;
+        }
+    }
+    return node(current).terminal;
+}
+
+QStringList MappedDictionary::suggestions(QStringView word, int maxDistance, int maxResults) const
+{
+    if (!m_data || word.isEmpty()) {
+        return {};
+    }
+
+    Search state;
+    state.word = word;
+    state.maxDistance = maxDistance;
+    QVarLengthArray<int, 64> firstRow(word.size() + 1);
+    for (int j = 0; j < firstRow.size(); ++j) {
+        firstRow[j] = j;
+    }
+    search(state, m_root, firstRow.constData());
+
+    std::sort(state.results.begin(), state.results.end(), [](const QPair<QString, int> &a, const QPair<QString, int> &b) {
+        if (a.second == b.second) {
+            return a.first < b.first;
+        }
+        return a.second < b.second;
+    });
+
+    QStringList result;
+    for (const auto &match : state.results) {
+        if (result.size() >= maxResults) {
+            break;
+        }
+        result.append(match.first);
+    }
+    return result;
+}
+
+void MappedDictionary::search(Search &state, quint32 index, const int *previousRow) const
+{
+    // Walks the DAWG carrying one Levenshtein row per prefix. A row whose every cell is
+    // over the bound can only grow, so that whole branch is skipped.
+    const Node parent = node(index);
+    const int m = state.word.size();
+    QVarLengthArray<int, 64> row(m + 1);
+    for (quint32 edge = parent.firstEdge; edge < parent.firstEdge + parent.edgeCount; ++edge) {
+        const char16_t label = edgeLabel(edge);
+        row[0] = previousRow[0] + 1;
+        int best = row[0];
+        for (int j = 1; j <= m; ++j) {
+            const int cost = state.word[j - 1].unicode() == label ? 0 : 1;
+            row[j] = std::min({previousRow[j] + 1, row[j - 1] + 1, previousRow[j - 1] + cost});
+            best = std::min(best, row[j]);
+        }
+        const quint32 target = edgeTarget(edge);
+        if (best > state.maxDistance || target >= m_nodeCount) {
+            continue;
+        }
+
+        state.prefix.append(QChar(label));
+        if (node(target).terminal && row[m] <= state.maxDistance) {
+            state.results.append({state.prefix, row[m]});
+        }
+        search(state, target, row.constData());
+        state.prefix.chop(1);
+    }
+}
+
+MappedDictionary::Node MappedDictionary::node(quint32 index) const
+{
+    const uchar *entry = m_nodes + qint64(index) * kNodeSize;
+    Node result;
+    result.firstEdge = qFromLittleEndian<quint32>(entry);
+    const quint32 packed = qFromLittleEndian<quint32>(entry + 4);
+    result.edgeCount = packed & ~kTerminalBit;
+    result.terminal = (packed & kTerminalBit) != 0;
+    // A damaged file must not send lookups past the mapping
+    if (result.firstEdge > m_edgeCount || result.edgeCount > m_edgeCount - result.firstEdge) {
+        result.edgeCount = 0;
+    }
+    return result;
+}
+
+quint16 MappedDictionary::edgeLabel(quint32 edge) const
+{
+    return qFromLittleEndian<quint16>(m_edges + qint64(edge) * kEdgeSize);
+}
+
+quint32 MappedDictionary::edgeTarget(quint32 edge) const
+{
+    return qFromLittleEndian<quint32>(m_edges + qint64(edge) * kEdgeSize + 4);
+}
+
+bool MappedDictionary::child(const Node &parent, char16_t label, quint32 &target) const
+{
+    quint32 low = parent.firstEdge;
+    quint32 high = parent.firstEdge + parent.edgeCount;
+    while (low < high) {
+        const quint32 mid = low + (high - low) / 2;
+        const quint16 midLabel = edgeLabel(mid);
+        if (midLabel < label) {
+            low = mid + 1;
+        } else if (midLabel > label) {
+            high = mid;
+        } else {
+            target = edgeTarget(mid);
+            return target < m_nodeCount;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,99 @@
+#include "mappedspellchecker.h"
+
+#include "basedictionary.h"
+#include "editdistance.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <algorithm>
+
+namespace {
+constexpr int kMaxSuggestionDistance = 2;
+constexpr int kMaxSuggestions = 6;
+}
+
+MappedDictionarySpellChecker::MappedDictionarySpellChecker(const QString &dictionaryPath, const QString &userDictionaryPath)
+    : m_userDictionary(userDictionaryPath)
+{
+    QString error;
+    if (!dictionaryPath.isEmpty() && QFile::exists(dictionaryPath) && !m_dictionary.open(dictionaryPath, &error)) {
+        qWarning() << "[Spellcheck]" << error;
+    }
+}
+
+QString MappedDictionarySpellChecker::defaultDictionaryPath()
+{
+    const QString configured = qEnvironmentVariable("SCREENQT_DICTIONARY");
+    if (!configured.isEmpty()) {
+        return configured;
+    }
+    return QDir(QCoreApplication::applicationDirPath()).filePath("dictionaries/en_US.sqtdict");
+}
+
+QList<Misspelling> MappedDictionarySpellChecker::checkText(const QString &text) const
+{
+    if (!isAvailable()) {
+        return {};
+    }
+    return findUnknownWords(text, [this](QStringView word) { return isKnownWord(word); });
+}
+
+QStringList MappedDictionarySpellChecker::suggestionsFor(const QString &word) const
+{
+    const QString normalized = word.trimmed().toLower();
+    if (normalized.isEmpty() || !isAvailable()) {
+        return {};
+    }
+
+    QMutexLocker locker(&m_suggestionMutex);
+    if (const QStringList *cached = m_suggestionCache.object(normalized)) {
+        return *cached;
+    }
+
+    QStringList suggestions = m_dictionary.suggestions(normalized, kMaxSuggestionDistance, kMaxSuggestions);
+    // User words are few; rank them in with the mapped ones
+    const QStringList userWords = m_userDictionary.words();
+    for (const QString &userWord : userWords) {
+        if (EditDistance::bounded(userWord, normalized, kMaxSuggestionDistance) <= kMaxSuggestionDistance) {
+            suggestions.append(userWord);
+        }
+    }
+    suggestions.removeDuplicates();
+    std::sort(suggestions.begin(), suggestions.end(), [&normalized](const QString &a, const QString &b) {
+        const int distanceA = EditDistance::bounded(a, normalized, kMaxSuggestionDistance);
+        const int distanceB = EditDistance::bounded(b, normalized, kMaxSuggestionDistance);
+        if (distanceA == distanceB) {
+            return a < b;
+        }
+        return distanceA < distanceB;
+    });
+    suggestions = suggestions.mid(0, kMaxSuggestions);
+
+    m_suggestionCache.insert(normalized, new QStringList(suggestions));
+    return suggestions;
+}
+
+void MappedDictionarySpellChecker::addWord(const QString &word)
+{
+    const QString normalized = word.trimmed().toLower();
+    if (normalized.isEmpty()) {
+        return;
+    }
+    if (!m_userDictionary.add(normalized)) {
+        return;
+    }
+
+    // The new word can now be suggested, so cached lists are out of date
+    QMutexLocker locker(&m_suggestionMutex);
+    m_suggestionCache.clear();
+}
+
+bool MappedDictionarySpellChecker::isKnownWord(QStringView word) const
+{
+    // Screenplay terms such as INT and EXT are missing from general dictionaries
+    if (BaseDictionary::contains(word) || m_dictionary.contains(word)) {
+        return true;
+    }
+    return m_userDictionary.contains(word);
+}
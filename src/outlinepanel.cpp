@@ -1,5 +1,6 @@
 #include "outlinepanel.h"
 
+#include "latencytrace.h"
 #include "scripteditor.h"
 
 #include <QLabel>
@@ -73,6 +74,7 @@ void OutlinePanel::setEditor(ScriptEditor *editor)
 
 void OutlinePanel::refreshOutline()
 {
+    LatencyTrace::Scope trace(LatencyTrace::OutlineRefresh);
     m_sceneList->clear();
 
     if (!m_editor) {
@@ -1,44 +1,37 @@
 #include "pageview.h"
 #include "pdfexporter.h"
+#include "screenplaydocumentlayout.h"
 #include "screenplayio.h"
 #include "scripteditor.h"
 #include <QGuiApplication>
 #include <QScreen>
 #include <QPainter>
+#include <QPaintEvent>
+#include <QPixmapCache>
 #include <QAbstractTextDocumentLayout>
 #include <QTextDocument>
 #include <QTextBlock>
 #include <QTextCursor>
-#include <QTextBlockFormat>
-#include <QTextLayout>
 #include <QFrame>
 #include <QScrollArea>
 #include <QDebug>
-#include <QTimer>
-#include <QSet>
+#include <algorithm>
 #include <cmath>
 
 namespace {
-int blockHeightPx(QTextDocument *doc, const QTextBlock &block) {
-    return static_cast<int>(std::ceil(doc->documentLayout()->blockBoundingRect(block).height()));
-}
-
 const QColor kPaperColor(246, 246, 242);
 const QColor kPageTextColor(36, 38, 44);
 const QColor kPageNumberColor(92, 96, 106);
-constexpr int kDialogueElementState = static_cast<int>(ScriptEditor::Dialogue);
 }
 
 PageView::PageView(QWidget *parent)
-    : QWidget(parent), m_editor(new ScriptEditor(this))
+    : QWidget(parent), m_editor(new ScriptEditor(this)),
+      m_documentLayout(new ScreenplayDocumentLayout(m_editor->document()))
 {
-    const qreal initialPointSize = m_editor->font().pointSizeF();
-    if (initialPointSize > 0.0) {
-        m_baseFontPointSize = initialPointSize;
-    }
-
     // Remove default document margin to align layout with page calculations
     m_editor->document()->setDocumentMargin(0);
+    // Pages are laid out by the document layout itself, so block formats stay untouched
+    m_editor->document()->setDocumentLayout(m_documentLayout);
     recalculatePageMetrics();
 
     // Editor inside printable area; disable scrollbars so outer view handles scrolling
@@ -54,10 +47,8 @@ PageView::PageView(QWidget *parent)
     m_editor->setAutoFillBackground(false);
     m_editor->viewport()->setAutoFillBackground(false);
 
-    // React to document size changes to paginate
-    connect(m_editor->document()->documentLayout(), &QAbstractTextDocumentLayout::documentSizeChanged,
-            this, &PageView::updatePagination);
-    connect(m_editor, &QTextEdit::textChanged, this, &PageView::enforcePageBreaks);
+    // The layout re-walks pages after every edit; follow its page count
+    connect(m_documentLayout, &ScreenplayDocumentLayout::paginationChanged, this, &PageView::updatePagination);
     connect(m_editor, &QTextEdit::cursorPositionChanged, this, &PageView::scrollToCursor);
 
     layoutPages();
@@ -65,65 +56,100 @@ PageView::PageView(QWidget *parent)
 
 void PageView::paintEvent(QPaintEvent *event)
 {
-    Q_UNUSED(event);
+    const QRect exposed = event->rect();
     QPainter p(this);
+    p.setClipRect(exposed);
     // Gray background
-    p.fillRect(rect(), QColor(BG_GRAY_VALUE, BG_GRAY_VALUE, BG_GRAY_VALUE));
+    p.fillRect(exposed, QColor(BG_GRAY_VALUE, BG_GRAY_VALUE, BG_GRAY_VALUE));
     
-    // Draw stacked pages with gaps - these provide the white background for text
-    int x = (width() - m_pageRect.width()) / 2;
-    if (x < PAGE_HORIZONTAL_PADDING) x = PAGE_HORIZONTAL_PADDING;
-    for (int i = 0; i < m_pageCount; ++i) {
-        int yOff = pageYOffset(i);
-        QRect pageRect(x, yOff, m_pageRect.width(), m_pageRect.height());
-        p.fillRect(pageRect, kPaperColor);
-        p.setPen(QPen(QColor(BORDER_GRAY_VALUE, BORDER_GRAY_VALUE, BORDER_GRAY_VALUE)));
-        p.drawRect(pageRect.adjusted(0, 0, -1, -1));
-        
-        // Draw white rectangle for printable area to ensure text has white background
-        QRect printableRect = m_printRect.translated(pageRect.topLeft());
-        p.fillRect(printableRect, kPaperColor);
+    // Draw only the stacked pages that intersect the exposed area - these provide the
+    // white background for text
+    const int x = pageX();
+    const int firstPage = pageAtY(exposed.top());
+    const int lastPage = pageAtY(exposed.bottom());
+    const QPixmap tile = pageTile();
+    for (int i = firstPage; i <= lastPage; ++i) {
+        p.drawPixmap(x, pageYOffset(i), tile);
     }
 
-    if (!m_continuationMarkers.isEmpty()) {
-        QFont markerFont("Courier New", 10);
-        p.setFont(markerFont);
+    const PaginationModel &pagination = m_documentLayout->pagination();
+    const QVector<ContinuationMarker> &markers = pagination.continuationMarkers();
+    if (!markers.isEmpty()) {
+        // Markers are placed in page units and zoom with the text
+        p.save();
+        p.translate(x, PAGE_HORIZONTAL_PADDING);
+        p.scale(m_zoomFactor, m_zoomFactor);
+        p.setFont(m_markerFont);
         p.setPen(kPageTextColor);
 
-        for (const ContinuationMarker &marker : m_continuationMarkers) {
-            if (marker.pageIndex < 0 || marker.pageIndex >= m_pageCount) {
-                continue;
+        // Markers are ordered by page, so only the visible pages' run is visited
+        auto marker = std::lower_bound(markers.cbegin(), markers.cend(), firstPage,
+                                       [](const ContinuationMarker &m, int page) { return m.pageIndex < page; });
+        for (; marker != markers.cend() && marker->pageIndex <= lastPage; ++marker) {
+            if (marker->pageIndex >= m_pageCount) {
+                break;
             }
 
-            const int markerPageTop = pageYOffset(marker.pageIndex);
-            const int markerX = x + m_printRect.left();
+            const int markerPageTop = (m_pageRect.height() + PAGE_GAP_PX) * marker->pageIndex;
+            const int markerX = m_printRect.left();
             int markerY = markerPageTop + m_printRect.top() + 4;
-            if (!marker.isTop) {
+            if (!marker->isTop) {
                 markerY = markerPageTop + m_printRect.top() + m_printRect.height() - 20;
             }
 
             QRect textRect(markerX, markerY, m_printRect.width(), 16);
-            p.drawText(textRect, Qt::AlignRight | Qt::AlignVCenter, marker.text);
+            p.drawText(textRect, Qt::AlignRight | Qt::AlignVCenter, marker->text);
         }
+        p.restore();
     }
     
-    const int pageTopMarginPx = m_printRect.top();
-    const int printableH = m_printRect.height();
+    // Debug overlay: replay the recorded pages around the exposed area, re-recording only
+    // those whose pagination generation is stale
+    if (m_debugMode) {
+        const int generation = pagination.generation();
+        if (m_debugOverlayPages.size() != m_pageCount) {
+            m_debugOverlayPages = QVector<DebugOverlayPage>(m_pageCount);
+        }
+        p.translate(x, PAGE_HORIZONTAL_PADDING);
+        p.scale(m_zoomFactor, m_zoomFactor);
+        // A block split across pages is recorded on the page it starts on
+        for (int i = qMax(0, firstPage - 1); i <= lastPage; ++i) {
+            DebugOverlayPage &overlay = m_debugOverlayPages[i];
+            if (overlay.generation != generation) {
+                overlay.picture = QPicture();
+                QPainter recorder(&overlay.picture);
+                recordDebugOverlayPage(recorder, i);
+                recorder.end();
+                overlay.generation = generation;
+            }
+            p.drawPicture(0, 0, overlay.picture);
+        }
+    }
+}
+
+void PageView::recordDebugOverlayPage(QPainter &p, int pageIndex) const
+{
+    // Recorded in page units with page 1's top-left corner at the origin, so the
+    // pictures survive zoom and resize; paintEvent maps them into the view
+    const PaginationModel &pagination = m_documentLayout->pagination();
     QTextDocument *doc = m_editor->document();
-    const int editorLeft = m_editor->geometry().left();
-    const int editorTop = m_editor->geometry().top();
+    const int x = 0;
+    const int editorLeft = m_printRect.left();
+    const int editorTop = m_printRect.top();
+    const int pageAdvance = m_pageRect.height() + PAGE_GAP_PX;
+    auto pagePrintableStartY = [&](int page) { return page * pageAdvance + m_printRect.top(); };
 
-    if (m_debugMode) {
-        // Draw page break reference lines
-        int calcPageStartY = 0;
-        int calcNaturalY = pageTopMarginPx;
+    const QFont headingFont("Courier New", 9, QFont::Bold);
+    const QFont labelFont("Courier New", 8);
+    const QFont smallFont("Courier New", 7);
 
+    if (pageIndex == 0) {
         // Draw page 1 printable area start reference
         int page1PaintableStart = pagePrintableStartY(0);
 
         p.setPen(QPen(Qt::yellow, 2, Qt::SolidLine));
         p.drawLine(x + m_printRect.left(), page1PaintableStart, x + m_printRect.left() + m_printRect.width(), page1PaintableStart);
-        p.setFont(QFont("Courier New", 9, QFont::Bold));
+        p.setFont(headingFont);
         p.setPen(Qt::yellow);
         p.drawText(QRect(x + m_printRect.left() + 5, page1PaintableStart - 20, 300, 20),
                   Qt::AlignLeft | Qt::AlignTop, "PAGE1_PRINTABLE_START");
@@ -140,235 +166,169 @@ void PageView::paintEvent(QPaintEvent *event)
             p.drawText(QRect(x + m_printRect.left() + 5, firstBlockScreenY - 20, 300, 20),
                       Qt::AlignLeft | Qt::AlignTop, QString("FIRST_BLOCK_ACTUAL | offset:%1px").arg(offsetDiff1));
         }
+    }
 
-        QTextBlock block = doc->begin();
-        int blockIdx = 0;
-        while (block.isValid()) {
-            QRectF blockRect = doc->documentLayout()->blockBoundingRect(block);
-            int blockHeight = blockHeightPx(doc, block);
-
-            int baseMargin = static_cast<int>(block.blockFormat().topMargin());
-            int existingPageBreakMargin = block.blockFormat().property(QTextFormat::UserProperty + 1).toInt();
-            int marginForCalc = baseMargin - existingPageBreakMargin;
-
-            int calcPrintableStartY = calcPageStartY + pageTopMarginPx;
-            int calcPosInPage = (calcNaturalY - calcPrintableStartY) + marginForCalc;
-
-            // Check if this block overflows
-            if (calcPosInPage + blockHeight > printableH && calcPosInPage > 0) {
-                // This block overflows - draw reference lines and info
-                int nextPageStartY = calcPageStartY + m_pageRect.height() + PAGE_GAP_PX;
-                int nextPagePrintableStart = nextPageStartY + pageTopMarginPx;
-                int pageBreakMargin = nextPagePrintableStart - (calcNaturalY + marginForCalc);
-
-                int screenY = pageYOffset(0) + nextPagePrintableStart + editorTop - m_editor->geometry().top();
-
-                // Draw cyan line showing calculated page 2 printable start
-                p.setPen(QPen(Qt::cyan, 3, Qt::SolidLine));
-                p.drawLine(x + m_printRect.left(), screenY, x + m_printRect.left() + m_printRect.width(), screenY);
-
-                // Draw info box with detailed calculations
-                p.setFont(QFont("Courier New", 9, QFont::Bold));
-                p.setPen(Qt::cyan);
-                QString calcInfo = QString("CALC_PAGE2_START:%1 | nextPageStartY:%2 | calcMargin:%3 | pageHeight:%4 | gap:%5 | calcPageStart:%6")
-                    .arg(nextPagePrintableStart).arg(nextPageStartY).arg(pageBreakMargin)
-                    .arg(m_pageRect.height()).arg(PAGE_GAP_PX).arg(calcPageStartY);
-                p.drawText(QRect(x + m_printRect.left() + 5, screenY - 50, m_printRect.width() - 10, 50),
-                          Qt::AlignLeft | Qt::AlignBottom, calcInfo);
-
-                // Draw the actual block position for comparison
-                int actualBlockY = static_cast<int>(blockRect.top()) + editorTop;
-                p.setPen(QPen(Qt::magenta, 2, Qt::DashLine));
-                p.drawLine(x + m_printRect.left(), actualBlockY, x + m_printRect.left() + m_printRect.width(), actualBlockY);
-                p.setPen(Qt::magenta);
-                p.setFont(QFont("Courier New", 8));
-                int offsetDiff = screenY - actualBlockY;
-                p.drawText(QRect(x + m_printRect.left() + 5, actualBlockY - 20, 300, 20),
-                          Qt::AlignLeft | Qt::AlignTop,
-                          QString("ACTUAL_BLOCK | offset_diff:%1px").arg(offsetDiff));
-
-                blockIdx++;
-                break;  // Just show the first page break for clarity
-            }
-
-            if (calcPosInPage + blockHeight > printableH && calcPosInPage > 0) {
-                calcPageStartY += m_pageRect.height() + PAGE_GAP_PX;
-                calcNaturalY = calcPageStartY + pageTopMarginPx + blockHeight;
-            } else {
-                calcNaturalY += marginForCalc + blockHeight;
-            }
-
-            blockIdx++;
-            block = block.next();
-        }
+    // Draw the first page break recorded by the pagination model
+    const QVector<PaginationModel::PageBreak> &pageBreaks = pagination.pageBreaks();
+    if (pageIndex == 1 && !pageBreaks.isEmpty()) {
+        const PaginationModel::PageBreak &firstBreak = pageBreaks.first();
+        const int screenY = pagePrintableStartY(1);
+
+        // Draw cyan line showing calculated page 2 printable start
+        p.setPen(QPen(Qt::cyan, 3, Qt::SolidLine));
+        p.drawLine(x + m_printRect.left(), screenY, x + m_printRect.left() + m_printRect.width(), screenY);
+
+        // Draw info box with detailed calculations
+        p.setFont(headingFont);
+        p.setPen(Qt::cyan);
+        QString calcInfo = QString("CALC_PAGE2_START:%1 | pageYOffset:%2 | pageHeight:%3 | gap:%4 | block:%5 | line:%6")
+            .arg(screenY).arg(pagination.pageYOffset(1))
+            .arg(m_pageRect.height()).arg(PAGE_GAP_PX).arg(firstBreak.blockNumber).arg(firstBreak.firstLine);
+        p.drawText(QRect(x + m_printRect.left() + 5, screenY - 50, m_printRect.width() - 10, 50),
+                  Qt::AlignLeft | Qt::AlignBottom, calcInfo);
+
+        // Draw the actual block position for comparison
+        const QTextBlock breakBlock = doc->findBlockByNumber(firstBreak.blockNumber);
+        QRectF blockRect = doc->documentLayout()->blockBoundingRect(breakBlock);
+        int actualBlockY = static_cast<int>(blockRect.top()) + editorTop;
+        p.setPen(QPen(Qt::magenta, 2, Qt::DashLine));
+        p.drawLine(x + m_printRect.left(), actualBlockY, x + m_printRect.left() + m_printRect.width(), actualBlockY);
+        p.setPen(Qt::magenta);
+        p.setFont(labelFont);
+        int offsetDiff = screenY - actualBlockY;
+        p.drawText(QRect(x + m_printRect.left() + 5, actualBlockY - 20, 300, 20),
+                  Qt::AlignLeft | Qt::AlignTop,
+                  QString("ACTUAL_BLOCK | offset_diff:%1px").arg(offsetDiff));
     }
     
-    // Debug mode: Draw colored boxes for each text block showing their heights
-    if (m_debugMode) {
-        // Color palette for debug boxes
-        QVector<QColor> colors = {
-            QColor(255, 100, 100, 100),  // Red
-            QColor(100, 255, 100, 100),  // Green
-            QColor(100, 100, 255, 100),  // Blue
-            QColor(255, 255, 100, 100),  // Yellow
-            QColor(255, 100, 255, 100),  // Magenta
-            QColor(100, 255, 255, 100),  // Cyan
-        };
-        
-        int colorIdx = 0;
-        int currentPage = 0;
-        int pageStartY = 0;
+    // Draw colored boxes for each text block starting on this page showing their heights
+    static const QVector<QColor> colors = {
+        QColor(255, 100, 100, 100),  // Red
+        QColor(100, 255, 100, 100),  // Green
+        QColor(100, 100, 255, 100),  // Blue
+        QColor(255, 255, 100, 100),  // Yellow
+        QColor(255, 100, 255, 100),  // Magenta
+        QColor(100, 255, 255, 100),  // Cyan
+    };
+
+    // Page assignment comes from the pagination model; only the block's actual
+    // position is read back from the layout.
+    const int firstBlockIdx = pagination.firstBlockOfPage(pageIndex);
+    const int nextPageBlockIdx = pagination.firstBlockOfPage(pageIndex + 1);
+    QTextBlock block = doc->findBlockByNumber(qMax(0, firstBlockIdx));
+    for (int blockIdx = qMax(0, firstBlockIdx);
+         firstBlockIdx >= 0 && block.isValid() && (nextPageBlockIdx < 0 || blockIdx <= nextPageBlockIdx);
+         block = block.next(), ++blockIdx) {
+        // The block continued from the previous page, or the one starting the next page
+        int blockPage = pagination.pageForBlock(blockIdx);
+        if (blockPage != pageIndex) {
+            continue;
+        }
+
+        // Get block dimensions
+        QRectF blockRect = doc->documentLayout()->blockBoundingRect(block);
+        int blockHeight = static_cast<int>(blockRect.height());
+        int blockY = static_cast<int>(blockRect.top()) + editorTop;
+        int blockX = editorLeft;
+        int blockWidth = m_printRect.width();
         
-        // Get the first page's absolute Y position
-        int firstPageAbsY = pageYOffset(0) + m_printRect.top();
+        // Draw colored box for this block
+        QColor blockColor = colors[blockIdx % colors.size()];
+        p.fillRect(QRect(blockX, blockY, blockWidth, blockHeight), blockColor);
+        p.setPen(QPen(Qt::black, 1));
+        p.drawRect(QRect(blockX, blockY, blockWidth, blockHeight));
         
-        // Also draw page break calculation info (reuse variables declared above)
-        int debugCalcPageStartY = 0;
-        int debugCalcNaturalY = pageTopMarginPx;
-        const int debugPageTopMarginPx = m_printRect.top();
-        int debugCalcNaturalYTracker = pageTopMarginPx;
+        // Draw height label
+        QString heightLabel = QString::number(blockHeight) + "px";
+        p.setFont(labelFont);
+        p.setPen(Qt::black);
+        p.drawText(QRect(blockX + 2, blockY + 2, blockWidth - 4, 20), Qt::AlignLeft | Qt::AlignTop, heightLabel);
         
-        QTextBlock block = doc->begin();
-        int blockIdx = 0;
-        while (block.isValid()) {
-            // Get block dimensions
-            QRectF blockRect = doc->documentLayout()->blockBoundingRect(block);
-            int blockHeight = blockHeightPx(doc, block);
-            int blockY = static_cast<int>(blockRect.top()) + editorTop;
-            int blockX = editorLeft;
-            int blockWidth = m_printRect.width();
-            
-            // Determine which page this block is on
-            int blockPage = 0;
-            int blockPageOffset = blockY - firstPageAbsY;
-            if (blockPageOffset < 0) blockPageOffset = 0;
-            
-            const int pageAdvance = printableH + PAGE_GAP_PX;
-            blockPage = blockPageOffset / pageAdvance;
-            if (blockPage >= m_pageCount) blockPage = m_pageCount - 1;
-            
-            // Draw colored box for this block
-            QColor blockColor = colors[colorIdx % colors.size()];
-            p.fillRect(QRect(blockX, blockY, blockWidth, blockHeight), blockColor);
-            p.setPen(QPen(Qt::black, 1));
-            p.drawRect(QRect(blockX, blockY, blockWidth, blockHeight));
-            
-            // Draw height label
-            QString heightLabel = QString::number(blockHeight) + "px";
-            QFont labelFont("Courier New", 8);
-            p.setFont(labelFont);
-            p.setPen(Qt::black);
-            p.drawText(QRect(blockX + 2, blockY + 2, blockWidth - 4, 20), Qt::AlignLeft | Qt::AlignTop, heightLabel);
-            
-            // Get top margin
-            int topMargin = static_cast<int>(block.blockFormat().topMargin());
-            if (topMargin > 0) {
-                QString marginLabel = "M:" + QString::number(topMargin) + "px";
-                p.drawText(QRect(blockX + 2, blockY + 18, blockWidth - 4, 20), Qt::AlignLeft | Qt::AlignTop, marginLabel);
-            }
-            
-            // Track calculated positions for page breaks
-            int baseMargin = topMargin;
-            int existingPageBreakMargin = block.blockFormat().property(QTextFormat::UserProperty + 1).toInt();
-            int marginForCalc = baseMargin - existingPageBreakMargin;
-            int calcPrintableStartY = debugCalcPageStartY + debugPageTopMarginPx;
-            int calcPosInPage = (debugCalcNaturalYTracker - calcPrintableStartY) + marginForCalc;
-            
-            // Draw calculated position line if on page 2+
-            if (blockPage > 0) {
-                // Draw a horizontal line showing where we calculated this block should be
-                int calcAbsY = pageYOffset(blockPage) + m_printRect.top() + (debugCalcNaturalYTracker - debugPageTopMarginPx);
-                p.setPen(QPen(Qt::magenta, 2, Qt::DashLine));
-                p.drawLine(blockX, calcAbsY, blockX + blockWidth, calcAbsY);
-                p.setPen(Qt::magenta);
-                p.setFont(QFont("Courier New", 7));
-                QString calcLabel = "CALC:" + QString::number(debugCalcNaturalYTracker);
-                p.drawText(QRect(blockX + 2, calcAbsY - 15, blockWidth - 4, 12), Qt::AlignLeft | Qt::AlignTop, calcLabel);
-            }
-            
-            // Update calculated tracking
-            if (calcPosInPage + blockHeight > printableH && calcPosInPage > 0) {
-                debugCalcPageStartY += m_pageRect.height() + PAGE_GAP_PX;
-                debugCalcNaturalYTracker = debugCalcPageStartY + debugPageTopMarginPx + blockHeight;
-            } else {
-                debugCalcNaturalYTracker += marginForCalc + blockHeight;
-            }
-            
-            colorIdx++;
-            blockIdx++;
-            block = block.next();
+        // Element spacing above the block (dropped at the top of a page)
+        int spaceBefore = pagination.blockRelativeY(blockIdx) > 0 ? pagination.blockSpaceBefore(blockIdx) : 0;
+        if (spaceBefore > 0) {
+            QString marginLabel = "M:" + QString::number(spaceBefore) + "px";
+            p.drawText(QRect(blockX + 2, blockY + 18, blockWidth - 4, 20), Qt::AlignLeft | Qt::AlignTop, marginLabel);
         }
         
-        // Draw margin boxes and page gaps for each page
-        for (int i = 0; i < m_pageCount; ++i) {
-            int pageAbsY = pageYOffset(i);
-            QRect pageAbsRect(x, pageAbsY, m_pageRect.width(), m_pageRect.height());
-            QRect printableAbsRect = m_printRect.translated(x, pageAbsY);
-            
-            // Draw top margin
-            QRect topMarginRect(pageAbsRect.left(), pageAbsRect.top(), pageAbsRect.width(), m_printRect.top());
-            p.fillRect(topMarginRect, QColor(200, 100, 100, 80));  // Red-ish
-            p.setPen(QPen(Qt::darkRed, 1));
-            p.drawRect(topMarginRect);
-            p.setFont(QFont("Courier New", 7));
-            p.setPen(Qt::darkRed);
-            p.drawText(topMarginRect, Qt::AlignCenter, "TOP");
-            
-            // Draw bottom margin
-            int bottomMarginHeight = m_pageRect.height() - (m_printRect.top() + m_printRect.height());
-            QRect bottomMarginRect(pageAbsRect.left(), printableAbsRect.bottom(), pageAbsRect.width(), bottomMarginHeight);
-            p.fillRect(bottomMarginRect, QColor(100, 200, 100, 80));  // Green-ish
-            p.setPen(QPen(Qt::darkGreen, 1));
-            p.drawRect(bottomMarginRect);
-            p.setFont(QFont("Courier New", 7));
-            p.setPen(Qt::darkGreen);
-            p.drawText(bottomMarginRect, Qt::AlignCenter, "BOTTOM");
-            
-            // Draw left margin
-            QRect leftMarginRect(pageAbsRect.left(), printableAbsRect.top(), m_printRect.left(), m_printRect.height());
-            p.fillRect(leftMarginRect, QColor(100, 100, 200, 80));  // Blue-ish
-            p.setPen(QPen(Qt::darkBlue, 1));
-            p.drawRect(leftMarginRect);
-            p.setFont(QFont("Courier New", 7));
-            p.setPen(Qt::darkBlue);
-            p.drawText(leftMarginRect, Qt::AlignCenter, "L");
-            
-            // Draw right margin
-            int rightMarginLeft = printableAbsRect.right();
-            int rightMarginWidth = pageAbsRect.right() - rightMarginLeft;
-            QRect rightMarginRect(rightMarginLeft, printableAbsRect.top(), rightMarginWidth, m_printRect.height());
-            p.fillRect(rightMarginRect, QColor(200, 200, 100, 80));  // Yellow-ish
-            p.setPen(QPen(Qt::darkYellow, 1));
-            p.drawRect(rightMarginRect);
-            p.setFont(QFont("Courier New", 7));
-            p.setPen(Qt::darkYellow);
-            p.drawText(rightMarginRect, Qt::AlignCenter, "R");
-            
-            // Draw printable area border
-            p.setPen(QPen(Qt::darkMagenta, 2, Qt::DashLine));
-            p.setBrush(Qt::NoBrush);
-            p.drawRect(printableAbsRect);
-            
-            // Label the printable area
-            QString pageLabel = "Page " + QString::number(i + 1) + " Printable";
-            QFont labelFont("Courier New", 8);
-            p.setFont(labelFont);
-            p.setPen(Qt::darkMagenta);
-            p.drawText(printableAbsRect.adjusted(2, 2, -2, -2), Qt::AlignTop | Qt::AlignLeft, pageLabel);
-            
-            // Draw page gap (if not the last page)
-            if (i < m_pageCount - 1) {
-                int gapY = pageAbsY + m_pageRect.height();
-                QRect gapRect(x, gapY, m_pageRect.width(), PAGE_GAP_PX);
-                p.fillRect(gapRect, QColor(150, 150, 150, 100));  // Gray
-                p.setPen(QPen(Qt::gray, 1, Qt::DotLine));
-                p.drawRect(gapRect);
-                p.setFont(QFont("Courier New", 7));
-                p.setPen(Qt::gray);
-                p.drawText(gapRect, Qt::AlignCenter, "GAP");
-            }
+        // Draw calculated page start line for the first block of pages 2+
+        if (blockPage > 0 && blockIdx == firstBlockIdx) {
+            int calcAbsY = pagePrintableStartY(blockPage);
+            p.setPen(QPen(Qt::magenta, 2, Qt::DashLine));
+            p.drawLine(blockX, calcAbsY, blockX + blockWidth, calcAbsY);
+            p.setPen(Qt::magenta);
+            p.setFont(smallFont);
+            QString calcLabel = "CALC:" + QString::number(calcAbsY) + " PAGE:" + QString::number(blockPage + 1);
+            p.drawText(QRect(blockX + 2, calcAbsY - 15, blockWidth - 4, 12), Qt::AlignLeft | Qt::AlignTop, calcLabel);
         }
     }
+
+    // Draw margin boxes and page gap for this page
+    int pageAbsY = pageIndex * pageAdvance;
+    QRect pageAbsRect(x, pageAbsY, m_pageRect.width(), m_pageRect.height());
+    QRect printableAbsRect = m_printRect.translated(x, pageAbsY);
+    
+    // Draw top margin
+    QRect topMarginRect(pageAbsRect.left(), pageAbsRect.top(), pageAbsRect.width(), m_printRect.top());
+    p.fillRect(topMarginRect, QColor(200, 100, 100, 80));  // Red-ish
+    p.setPen(QPen(Qt::darkRed, 1));
+    p.drawRect(topMarginRect);
+    p.setFont(smallFont);
+    p.setPen(Qt::darkRed);
+    p.drawText(topMarginRect, Qt::AlignCenter, "TOP");
+    
+    // Draw bottom margin
+    int bottomMarginHeight = m_pageRect.height() - (m_printRect.top() + m_printRect.height());
+    QRect bottomMarginRect(pageAbsRect.left(), printableAbsRect.bottom(), pageAbsRect.width(), bottomMarginHeight);
+    p.fillRect(bottomMarginRect, QColor(100, 200, 100, 80));  // Green-ish
+    p.setPen(QPen(Qt::darkGreen, 1));
+    p.drawRect(bottomMarginRect);
+    p.setFont(smallFont);
+    p.setPen(Qt::darkGreen);
+    p.drawText(bottomMarginRect, Qt::AlignCenter, "BOTTOM");
+    
+    // Draw left margin
+    QRect leftMarginRect(pageAbsRect.left(), printableAbsRect.top(), m_printRect.left(), m_printRect.height());
+    p.fillRect(leftMarginRect, QColor(100, 100, 200, 80));  // Blue-ish
+    p.setPen(QPen(Qt::darkBlue, 1));
+    p.drawRect(leftMarginRect);
+    p.setFont(smallFont);
+    p.setPen(Qt::darkBlue);
+    p.drawText(leftMarginRect, Qt::AlignCenter, "L");
+    
+    // Draw right margin
+    int rightMarginLeft = printableAbsRect.right();
+    int rightMarginWidth = pageAbsRect.right() - rightMarginLeft;
+    QRect rightMarginRect(rightMarginLeft, printableAbsRect.top(), rightMarginWidth, m_printRect.height());
+    p.fillRect(rightMarginRect, QColor(200, 200, 100, 80));  // Yellow-ish
+    p.setPen(QPen(Qt::darkYellow, 1));
+    p.drawRect(rightMarginRect);
+    p.setFont(smallFont);
+    p.setPen(Qt::darkYellow);
+    p.drawText(rightMarginRect, Qt::AlignCenter, "R");
+    
+    // Draw printable area border
+    p.setPen(QPen(Qt::darkMagenta, 2, Qt::DashLine));
+    p.setBrush(Qt::NoBrush);
+    p.drawRect(printableAbsRect);
+    
+    // Label the printable area
+    QString pageLabel = "Page " + QString::number(pageIndex + 1) + " Printable";
+    p.setFont(labelFont);
+    p.setPen(Qt::darkMagenta);
+    p.drawText(printableAbsRect.adjusted(2, 2, -2, -2), Qt::AlignTop | Qt::AlignLeft, pageLabel);
+    
+    // Draw page gap (if not the last page)
+    if (pageIndex < m_pageCount - 1) {
+        int gapY = pageAbsY + m_pageRect.height();
+        QRect gapRect(x, gapY, m_pageRect.width(), PAGE_GAP_PX);
+        p.fillRect(gapRect, QColor(150, 150, 150, 100));  // Gray
+        p.setPen(QPen(Qt::gray, 1, Qt::DotLine));
+        p.drawRect(gapRect);
+        p.setFont(smallFont);
+        p.setPen(Qt::gray);
+        p.drawText(gapRect, Qt::AlignCenter, "GAP");
+    }
 }
 
 void PageView::resizeEvent(QResizeEvent *event)
@@ -381,6 +341,7 @@ void PageView::setDebugMode(bool enabled)
 {
     if (m_debugMode != enabled) {
         m_debugMode = enabled;
+        m_debugOverlayPages.clear();
         update();  // Redraw with or without debug visualization
     }
 }
@@ -388,86 +349,39 @@ void PageView::setDebugMode(bool enabled)
 
 void PageView::layoutPages()
 {
-    // qDebug() << "[PageView] === layoutPages START ===\";
-    // qDebug() << "[PageView] pageCount:" << m_pageCount;
-    // qDebug() << "[PageView] pageRect:" << m_pageRect;
-    // qDebug() << "[PageView] printRect (relative):" << m_printRect;
-    // qDebug() << "[PageView] pageGap:" << PAGE_GAP_PX;
-    
-    // Base page position centered horizontally, start near top
-    int x = (width() - m_pageRect.width()) / 2;
-    if (x < PAGE_HORIZONTAL_PADDING) x = PAGE_HORIZONTAL_PADDING;
-    int startY = PAGE_HORIZONTAL_PADDING;
-    m_pageRect.moveTopLeft(QPoint(x, startY));
+    // Pages are laid out in page units and shown scaled by the zoom factor
+    const int x = pageX();
+    const int startY = PAGE_HORIZONTAL_PADDING;
 
     // Printable width/height
     const int printableW = m_printRect.width();
-    const int printableH = m_printRect.height();
-    // qDebug() << "[PageView] printableW:" << printableW << "printableH:" << printableH;
-
-    // Compute first page printable rect (absolute position)
-    QRect firstPrint = m_printRect.translated(x, startY);
-    // qDebug() << "[PageView] firstPrint (absolute):" << firstPrint;
 
     // Editor height spans all pages (full page height including margins) PLUS gaps between pages
     // This ensures editor Y coordinates align with painted page positions
-    int totalEditorHeight = m_pageRect.height() * m_pageCount + PAGE_GAP_PX * (m_pageCount - 1);
-    // qDebug() << "[PageView] totalEditorHeight:" << totalEditorHeight;
+    const int totalPageHeight = m_pageRect.height() * m_pageCount + PAGE_GAP_PX * (m_pageCount - 1);
     
-    m_editor->setGeometry(QRect(firstPrint.left(), firstPrint.top(), printableW, totalEditorHeight));
-    // qDebug() << "[PageView] editor geometry:" << m_editor->geometry();
+    m_editor->setGeometry(QRect(x + toView(m_printRect.left()), startY + toView(m_printRect.top()),
+                                toView(printableW), toView(totalPageHeight)));
     
-    // Ensure editor respects line wrap width
-    m_editor->setLineWrapColumnOrWidth(printableW);
+    // Ensure editor wraps at the printable width in page units; a new wrap width relayouts
+    // the whole document, so zooming never changes it
+    if (m_editor->lineWrapColumnOrWidth() != printableW) {
+        m_editor->setLineWrapColumnOrWidth(printableW);
+    }
 
     // Set fixed size for this widget
-    int totalPageHeight = m_pageRect.height() * m_pageCount + PAGE_GAP_PX * (m_pageCount - 1);
-    int fixedWidth = m_pageRect.width() + WIDGET_HORIZONTAL_PADDING;
+    int fixedWidth = toView(m_pageRect.width()) + WIDGET_HORIZONTAL_PADDING;
     setMinimumWidth(fixedWidth);
     setMaximumWidth(QWIDGETSIZE_MAX);
-    setMinimumHeight(totalPageHeight + WIDGET_VERTICAL_PADDING);
-    setMaximumHeight(totalPageHeight + WIDGET_VERTICAL_PADDING);
+    setMinimumHeight(toView(totalPageHeight) + WIDGET_VERTICAL_PADDING);
+    setMaximumHeight(toView(totalPageHeight) + WIDGET_VERTICAL_PADDING);
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
-    // qDebug() << "[PageView] widget size:" << size();
-    // qDebug() << "[PageView] === layoutPages END ===";
 }
 
 void PageView::updatePagination()
 {
-    // Recompute pages by simulating pagination without mutating the document.
-    // Uses ABSOLUTE coordinates: naturalY starts at pageTopMarginPx, pageStartY at 0
-    const int printableH = m_printRect.height();
-    const int pageTopMarginPx = m_printRect.top();
-    const int pageHeight = m_pageRect.height();
-    
-    int pages = 1;
-    int pageStartY = 0;              // Physical top of current page
-    int naturalY = pageTopMarginPx;  // Current position (starts at page 1 printable top)
-
-    QTextDocument *doc = m_editor->document();
-    QTextBlock block = doc->begin();
-    while (block.isValid()) {
-        int blockHeight = blockHeightPx(doc, block);
-        int blockTopMargin = static_cast<int>(block.blockFormat().topMargin());
-
-        // Position within current page's printable area
-        int printableStartY = pageStartY + pageTopMarginPx;
-        int posInPage = (naturalY - printableStartY) + blockTopMargin;
-
-        if (posInPage + blockHeight > printableH && posInPage > 0) {
-            // move to next page
-            pages++;
-            pageStartY += pageHeight + PAGE_GAP_PX;
-            naturalY = pageStartY + pageTopMarginPx + blockTopMargin + blockHeight;
-        } else {
-            naturalY += blockTopMargin + blockHeight;
-        }
-
-        block = block.next();
-    }
-
-    if (pages < 1) pages = 1;
-    // qDebug() << "[PageView] updatePagination: pages=" << pages << "naturalY=" << naturalY << "printableH=" << printableH;
+    // Page count follows the document layout's last page walk
+    int pages = m_documentLayout->pagination().pageCount();
     if (pages != m_pageCount) {
         m_pageCount = pages;
         layoutPages();
@@ -488,8 +402,20 @@ double PageView::dpiY() const
     return screen ? screen->logicalDotsPerInchY() : DEFAULT_DPI;
 }
 
-double PageView::inchToPxX(double inches) const { return inches * dpiX() * m_zoomFactor; }
-double PageView::inchToPxY(double inches) const { return inches * dpiY() * m_zoomFactor; }
+double PageView::inchToPxX(double inches) const { return inches * dpiX(); }
+double PageView::inchToPxY(double inches) const { return inches * dpiY(); }
+
+int PageView::toView(qreal pageUnits) const
+{
+    return qRound(pageUnits * m_zoomFactor);
+}
+
+int PageView::pageX() const
+{
+    // Pages are centered horizontally with a minimum padding
+    const int x = (width() - toView(m_pageRect.width())) / 2;
+    return qMax(x, static_cast<int>(PAGE_HORIZONTAL_PADDING));
+}
 
 void PageView::recalculatePageMetrics()
 {
@@ -502,20 +428,14 @@ void PageView::recalculatePageMetrics()
     int top = static_cast<int>(inchToPxY(MARGIN_TOP_INCHES));
     int bottom = static_cast<int>(inchToPxY(MARGIN_BOTTOM_INCHES));
     m_printRect = QRect(left, top, pageW - left - right, pageH - top - bottom);
+    m_documentLayout->setPageMetrics(pageH, PAGE_GAP_PX, m_printRect.height());
 }
 
 void PageView::applyZoom()
 {
+    // Zoom is a view transform: the layout, and so the page count, stays as it is
     m_zoomFactor = std::pow(ZOOM_STEP_MULTIPLIER, m_zoomSteps);
-
-    QFont editorFont = m_editor->font();
-    editorFont.setPointSizeF(m_baseFontPointSize * m_zoomFactor);
-    m_editor->setFont(editorFont);
-
-    recalculatePageMetrics();
-    m_editor->formatDocument();
-    enforcePageBreaks();
-    updatePagination();
+    m_editor->setZoomFactor(m_zoomFactor);
     layoutPages();
     update();
 }
@@ -560,13 +480,54 @@ void PageView::setZoomSteps(int steps)
 
 int PageView::pageYOffset(int pageIndex) const
 {
-    // Y offset for page N: startY + (pageHeight + gap) * N
-    return PAGE_HORIZONTAL_PADDING + (m_pageRect.height() + PAGE_GAP_PX) * pageIndex;
+    // Y offset for page N: startY + (pageHeight + gap) * N, scaled into the view
+    return PAGE_HORIZONTAL_PADDING + toView(qreal(m_pageRect.height() + PAGE_GAP_PX) * pageIndex);
 }
 
 int PageView::pagePrintableStartY(int pageIndex) const
 {
-    return pageYOffset(pageIndex) + m_printRect.top();
+    return PAGE_HORIZONTAL_PADDING + toView(qreal(m_pageRect.height() + PAGE_GAP_PX) * pageIndex + m_printRect.top());
+}
+
+int PageView::pageAtY(int y) const
+{
+    // Inverse of pageYOffset(); a y inside a gap belongs to the page above it
+    const qreal advance = (m_pageRect.height() + PAGE_GAP_PX) * m_zoomFactor;
+    if (advance <= 0 || y < PAGE_HORIZONTAL_PADDING) {
+        return 0;
+    }
+    return qMin(static_cast<int>((y - PAGE_HORIZONTAL_PADDING) / advance), m_pageCount - 1);
+}
+
+QPixmap PageView::pageTile() const
+{
+    // Paper, border and printable area are identical on every page, so they are
+    // rendered once per page size, zoom level and device pixel ratio
+    const qreal ratio = devicePixelRatioF();
+    const QSize viewSize(toView(m_pageRect.width()), toView(m_pageRect.height()));
+    const QString key = QStringLiteral("screenqt-page-%1x%2-%3-%4-%5")
+                            .arg(m_pageRect.width()).arg(m_pageRect.height())
+                            .arg(m_printRect.top()).arg(m_zoomFactor).arg(ratio);
+    QPixmap tile;
+    if (QPixmapCache::find(key, &tile)) {
+        return tile;
+    }
+
+    tile = QPixmap(viewSize * ratio);
+    tile.setDevicePixelRatio(ratio);
+    tile.fill(kPaperColor);
+    QPainter p(&tile);
+    const QRect pageRect(QPoint(0, 0), viewSize);
+    p.setPen(QPen(QColor(BORDER_GRAY_VALUE, BORDER_GRAY_VALUE, BORDER_GRAY_VALUE)));
+    p.drawRect(pageRect.adjusted(0, 0, -1, -1));
+    
+    // Draw white rectangle for printable area to ensure text has white background
+    p.fillRect(QRect(toView(m_printRect.left()), toView(m_printRect.top()),
+                     toView(m_printRect.width()), toView(m_printRect.height())), kPaperColor);
+    p.end();
+
+    QPixmapCache::insert(key, tile);
+    return tile;
 }
 
 bool PageView::saveToFile(const QString &filePath)
@@ -590,14 +551,12 @@ bool PageView::saveToFile(const QString &filePath)
 bool PageView::loadFromFile(const QString &filePath)
 {
     qDebug() << "[PageView] Loading from:" << filePath;
-    m_loading = true; // Prevent enforcePageBreaks during load
 
     int loadedLineCount = 0;
     DocumentSettings loadedSettings;
     const bool ok = ScreenplayIO::loadDocument(m_editor, filePath, loadedLineCount, &loadedSettings);
     if (!ok) {
         qDebug() << "[PageView] Failed to load screenplay";
-        m_loading = false;
         return false;
     }
 
@@ -605,15 +564,7 @@ bool PageView::loadFromFile(const QString &filePath)
 
     m_editor->moveCursor(QTextCursor::Start);
     m_editor->formatDocument();
-
-    // Clear loading flag, disconnect textChanged, run enforcePageBreaks once, clear undo, reconnect
-    QTimer::singleShot(0, this, [this]() {
-        m_loading = false;
-        disconnect(m_editor, &QTextEdit::textChanged, this, &PageView::enforcePageBreaks);
-        enforcePageBreaks();
-        m_editor->document()->clearUndoRedoStacks();
-        connect(m_editor, &QTextEdit::textChanged, this, &PageView::enforcePageBreaks);
-    });
+    m_editor->document()->clearUndoRedoStacks();
 
     return true;
 }
@@ -626,6 +577,8 @@ bool PageView::exportToPdf(const QString &filePath)
     settings.printableWidthPx = m_printRect.width();
     settings.printableHeightPx = printableHeightPerPage();
     settings.topMarginPx = m_printRect.top();
+    settings.pageHeightPx = m_pageRect.height();
+    settings.pagination = &m_documentLayout->pagination();
 
     settings.marginLeftInches = MARGIN_LEFT_INCHES;
     settings.marginRightInches = MARGIN_RIGHT_INCHES;
@@ -653,152 +606,9 @@ int PageView::printableHeight() const
     return m_printRect.height();
 }
 
-void PageView::enforcePageBreaks()
+const PaginationModel &PageView::pagination() const
 {
-    // Guard against recursive calls
-    if (m_enforcingBreaks) {
-        return;
-    }
-    
-    // Skip during document loading/initialization
-    if (m_loading) {
-        return;
-    }
-    
-    m_enforcingBreaks = true;
-    
-    // Temporarily disconnect textChanged to prevent re-triggering during modifications
-    disconnect(m_editor, &QTextEdit::textChanged, this, &PageView::enforcePageBreaks);
-    
-    QTextDocument *doc = m_editor->document();
-    const int printableH = printableHeightPerPage();
-    const int pageTopMarginPx = m_printRect.top();
-    const int pageBottomMarginPx = m_pageRect.height() - (m_printRect.top() + m_printRect.height());
-    
-    // Calculate which blocks need page break margins and what those margins should be
-    // Key: block position, Value: required top margin for page break
-    QMap<int, int> requiredPageBreakMargins;
-    QVector<ContinuationMarker> newMarkers;
-    QSet<QString> markerKeys;
-    
-    // Use ABSOLUTE coordinates throughout:
-    // - naturalY starts at pageTopMarginPx (96) - first content position below page 1's top margin
-    // - pageStartY starts at 0 - physical top of page 1
-    // - Page boundaries: pageHeight (1056) + gap (30)
-    // - Printable area on page N starts at: pageStartY + pageTopMarginPx
-    
-    int naturalY = pageTopMarginPx;  // Start at page 1's printable top (absolute)
-    int pageStartY = 0;              // Physical top of current page
-    
-    int blockIdx = 0;
-    for (QTextBlock block = doc->begin(); block.isValid(); block = block.next()) {
-        QTextBlockFormat fmt = block.blockFormat();
-        int blockHeight = blockHeightPx(doc, block);
-        
-        // Get the block's base margin (element type margin, not pagination margin)
-        int baseMargin = static_cast<int>(fmt.topMargin());
-        
-        // For this calculation, use only the base margin (ignore any existing page break margin)
-        int existingPageBreakMargin = fmt.property(QTextFormat::UserProperty + 1).toInt();
-        int marginForCalculation = baseMargin - existingPageBreakMargin;
-        
-        // Calculate position within current page's printable area
-        // Printable area starts at pageStartY + pageTopMarginPx
-        int printableStartY = pageStartY + pageTopMarginPx;
-        int posInPage = (naturalY - printableStartY) + marginForCalculation;
-        
-        // Does it overflow the page?
-        if (posInPage + blockHeight > printableH && posInPage > 0) {
-            // Block needs to be pushed to the next page
-            // Next page starts at: pageStartY + pageHeight + gap
-            int nextPageStartY = pageStartY + m_pageRect.height() + PAGE_GAP_PX;
-            // Next page's printable area starts at: nextPageStartY + pageTopMarginPx
-            int nextPagePrintableStart = nextPageStartY + pageTopMarginPx;
-            
-            // The page break margin pushes the block from its current position to the next page's printable start
-            // Block top is at: naturalY
-            // We want block top at: nextPagePrintableStart
-            // So we need extra margin of: nextPagePrintableStart - naturalY
-            int pageBreakMargin = nextPagePrintableStart - naturalY;
-            // For pages beyond the first, remove the base margin contribution to prevent drift
-            if (pageStartY > 0) {
-                pageBreakMargin -= marginForCalculation;
-            }
-            
-            requiredPageBreakMargins[block.position()] = pageBreakMargin;
-
-            if (block.userState() == kDialogueElementState) {
-                const int pageAdvance = m_pageRect.height() + PAGE_GAP_PX;
-                const int previousPageIndex = pageStartY / pageAdvance;
-                const int nextPageIndex = previousPageIndex + 1;
-
-                const QString lowerKey = QString("%1:%2").arg(previousPageIndex).arg("MORE");
-                if (!markerKeys.contains(lowerKey)) {
-                    markerKeys.insert(lowerKey);
-                    newMarkers.append(ContinuationMarker{previousPageIndex, false, "(MORE)"});
-                }
-
-                const QString upperKey = QString("%1:%2").arg(nextPageIndex).arg("CONTD");
-                if (!markerKeys.contains(upperKey)) {
-                    markerKeys.insert(upperKey);
-                    newMarkers.append(ContinuationMarker{nextPageIndex, true, "(CONT'D)"});
-                }
-            }
-            
-            // Move to next page tracking
-            pageStartY = nextPageStartY;
-            // naturalY = where this block ends on the new page (printable start + block height)
-            naturalY = nextPagePrintableStart + blockHeight;
-        } else {
-            naturalY += marginForCalculation + blockHeight;
-        }
-        blockIdx++;
-    }
-
-    m_continuationMarkers = newMarkers;
-    update();
-    
-    // Now check current state and only modify if needed
-    bool needsChanges = false;
-    for (QTextBlock block = doc->begin(); block.isValid(); block = block.next()) {
-        QTextBlockFormat fmt = block.blockFormat();
-        int currentPageBreakMargin = fmt.property(QTextFormat::UserProperty + 1).toInt();
-        int requiredMargin = requiredPageBreakMargins.value(block.position(), 0);
-        
-        if (currentPageBreakMargin != requiredMargin) {
-            needsChanges = true;
-            break;
-        }
-    }
-    
-    // Only modify document if changes are needed
-    if (needsChanges) {
-        QTextCursor cursor(doc);
-        cursor.beginEditBlock();
-        
-        for (QTextBlock block = doc->begin(); block.isValid(); block = block.next()) {
-            QTextBlockFormat fmt = block.blockFormat();
-            int currentPageBreakMargin = fmt.property(QTextFormat::UserProperty + 1).toInt();
-            int requiredMargin = requiredPageBreakMargins.value(block.position(), 0);
-            
-            if (currentPageBreakMargin != requiredMargin) {
-                // Need to update this block's margin
-                int baseMargin = static_cast<int>(fmt.topMargin()) - currentPageBreakMargin;
-                int newTotalMargin = baseMargin + requiredMargin;
-                
-                cursor.setPosition(block.position());
-                fmt.setTopMargin(newTotalMargin);
-                fmt.setProperty(QTextFormat::UserProperty + 1, requiredMargin);
-                cursor.setBlockFormat(fmt);
-            }
-        }
-        
-        cursor.endEditBlock();
-    }
-    
-    // Reconnect textChanged and reset flag
-    connect(m_editor, &QTextEdit::textChanged, this, &PageView::enforcePageBreaks);
-    m_enforcingBreaks = false;
+    return m_documentLayout->pagination();
 }
 
 void PageView::scrollToCursor()
@@ -813,7 +623,7 @@ void PageView::scrollToCursor()
     if (!sa) return;
 
     // Cursor rect in editor coords
-    QRect cr = m_editor->cursorRect();
+    QRect cr = m_editor->viewCursorRect();
     // Map to PageView coords
     QPoint center = m_editor->mapTo(this, cr.center());
     int xMargin = SCROLL_X_MARGIN;
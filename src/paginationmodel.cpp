@@ -0,0 +1,298 @@
+#include "paginationmodel.h"
+#include "scripteditor.h"
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QTextLayout>
+#include <QtMath>
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace {
+// Content height as placed by the layout: whole-pixel line heights stacked without gaps
+int layoutHeightPx(const QTextBlock &block) {
+    const QTextLayout *layout = block.layout();
+    int height = 0;
+    for (int i = 0; layout && i < layout->lineCount(); ++i) {
+        height += qCeil(layout->lineAt(i).height());
+    }
+    return height;
+}
+
+constexpr int kDialogueElementState = static_cast<int>(ScriptEditor::Dialogue);
+}
+
+void PaginationModel::setPageMetrics(int pageHeight, int pageGap, int printableHeight)
+{
+    if (pageHeight == m_pageHeight && pageGap == m_pageGap && printableHeight == m_printableHeight) {
+        return;
+    }
+    m_pageHeight = pageHeight;
+    m_pageGap = pageGap;
+    m_printableHeight = printableHeight;
+    invalidate(m_blockExtents.size());
+}
+
+void PaginationModel::invalidate(int blockCount)
+{
+    m_blockExtents.fill(BlockExtent(), blockCount);
+    m_pageBreaks.clear();
+    m_continuationMarkers.clear();
+    m_dirtyFirstBlock = -1;
+    m_dirtyLastBlock = -1;
+    markBlocksDirty(0, blockCount - 1);
+    ++m_generation;
+}
+
+void PaginationModel::contentsChanged(const QTextDocument *document, int position, int charsAdded)
+{
+    const int blockCount = document->blockCount();
+    const int oldBlockCount = m_blockExtents.size();
+    const int delta = blockCount - oldBlockCount;
+
+    QTextBlock firstBlock = document->findBlock(position);
+    QTextBlock lastBlock = document->findBlock(position + charsAdded);
+    const int first = firstBlock.isValid() ? firstBlock.blockNumber() : blockCount - 1;
+    const int last = lastBlock.isValid() ? qMax(first, lastBlock.blockNumber()) : blockCount - 1;
+    const int oldLast = last - delta;
+
+    if (oldBlockCount == 0 || first < 0 || oldLast < first || oldLast >= oldBlockCount) {
+        invalidate(blockCount);
+        return;
+    }
+
+    // An edit within existing blocks keeps their extents and breaks, so update() can tell
+    // whether anything moved; the dirty range alone makes it measure them again
+    if (delta == 0) {
+        markBlocksDirty(first, last);
+        return;
+    }
+
+    // Replace the old block range [first, oldLast] with [first, last], all unmeasured
+    m_blockExtents.remove(first, oldLast - first + 1);
+    m_blockExtents.insert(first, last - first + 1, BlockExtent());
+
+    // Breaks inside the edited range are recomputed; later ones shift with the blocks
+    QVector<PageBreak> keptBreaks;
+    keptBreaks.reserve(m_pageBreaks.size());
+    for (PageBreak pageBreak : std::as_const(m_pageBreaks)) {
+        if (pageBreak.blockNumber >= first && pageBreak.blockNumber <= oldLast) {
+            continue;
+        }
+        if (pageBreak.blockNumber > oldLast) {
+            pageBreak.blockNumber += delta;
+        }
+        keptBreaks.append(pageBreak);
+    }
+    m_pageBreaks = keptBreaks;
+
+    if (m_dirtyFirstBlock >= 0) {
+        if (m_dirtyFirstBlock > oldLast) {
+            m_dirtyFirstBlock += delta;
+        }
+        if (m_dirtyLastBlock > oldLast) {
+            m_dirtyLastBlock += delta;
+        }
+    }
+    markBlocksDirty(first, last);
+}
+
+bool PaginationModel::needsUpdate(const QTextDocument *document) const
+{
+    return m_dirtyFirstBlock >= 0 || m_blockExtents.size() != document->blockCount();
+}
+
+void PaginationModel::markBlocksDirty(int firstBlock, int lastBlock)
+{
+    if (m_dirtyFirstBlock < 0) {
+        m_dirtyFirstBlock = firstBlock;
+        m_dirtyLastBlock = lastBlock;
+    } else {
+        m_dirtyFirstBlock = qMin(m_dirtyFirstBlock, firstBlock);
+        m_dirtyLastBlock = qMax(m_dirtyLastBlock, lastBlock);
+    }
+    m_dirtyFirstBlock = qMax(0, m_dirtyFirstBlock);
+    m_dirtyLastBlock = qMin(m_dirtyLastBlock, static_cast<int>(m_blockExtents.size()) - 1);
+}
+
+PaginationModel::BlockRange PaginationModel::dirtyBlocks() const
+{
+    return BlockRange{m_dirtyFirstBlock, m_dirtyLastBlock};
+}
+
+PaginationModel::BlockRange PaginationModel::update(const QTextDocument *document)
+{
+    BlockRange walked;
+    if (m_blockExtents.size() != document->blockCount()) {
+        invalidate(document->blockCount());
+    }
+    if (m_dirtyFirstBlock < 0) {
+        return walked;
+    }
+
+    const int dirtyFirst = m_dirtyFirstBlock;
+    const int dirtyLast = m_dirtyLastBlock;
+    // Until page metrics are known everything stays on one page
+    const int pageLimit = m_printableHeight > 0 ? m_printableHeight : std::numeric_limits<int>::max() / 2;
+
+    // Restart at the last block that opened a page before the first dirty block: it sits at
+    // the top of a fresh page, so nothing before it needs walking again.
+    int startBlock = 0;
+    int keptBreakCount = 0;
+    for (int i = m_pageBreaks.size() - 1; i >= 0; --i) {
+        const PageBreak &pageBreak = m_pageBreaks.at(i);
+        if (pageBreak.firstLine == 0 && pageBreak.blockNumber < dirtyFirst) {
+            startBlock = pageBreak.blockNumber;
+            keptBreakCount = i + 1;
+            break;
+        }
+    }
+
+    QVector<PageBreak> newBreaks = m_pageBreaks.mid(0, keptBreakCount);
+    int oldBreakIndex = keptBreakCount;
+    int y = 0; // Bottom of the content placed so far, below the current page's printable top
+    walked.firstBlock = startBlock;
+    walked.lastBlock = static_cast<int>(m_blockExtents.size()) - 1;
+
+    bool extentsChanged = false;
+    QTextBlock block = document->findBlockByNumber(startBlock);
+    for (int blockNumber = startBlock; block.isValid(); block = block.next(), ++blockNumber) {
+        BlockExtent &extent = m_blockExtents[blockNumber];
+        const BlockExtent previous = extent;
+        if ((blockNumber >= dirtyFirst && blockNumber <= dirtyLast) || extent.height < 0) {
+            extent.height = layoutHeightPx(block);
+            extent.spaceBefore = qRound(block.blockFormat().topMargin());
+        }
+
+        // A block that does not fit below the content already on the page starts the next one
+        if (y > 0 && y + extent.spaceBefore + extent.height > pageLimit) {
+            y = 0;
+            while (oldBreakIndex < m_pageBreaks.size()
+                   && m_pageBreaks.at(oldBreakIndex).blockNumber < blockNumber) {
+                ++oldBreakIndex;
+            }
+            // Past the edit, a block that opened a page last run too is placed exactly as before,
+            // and so is everything after it: reuse the rest of the previous walk.
+            if (blockNumber > dirtyLast && oldBreakIndex < m_pageBreaks.size()
+                && m_pageBreaks.at(oldBreakIndex).blockNumber == blockNumber
+                && m_pageBreaks.at(oldBreakIndex).firstLine == 0) {
+                newBreaks += m_pageBreaks.mid(oldBreakIndex);
+                walked.lastBlock = blockNumber - 1;
+                break;
+            }
+            newBreaks.append(PageBreak{blockNumber, 0});
+        }
+
+        // Element spacing is dropped at the top of a page
+        extent.relativeY = (y == 0) ? 0 : y + extent.spaceBefore;
+        y = extent.relativeY + extent.height;
+        extentsChanged = extentsChanged || extent.height != previous.height
+            || extent.spaceBefore != previous.spaceBefore || extent.relativeY != previous.relativeY;
+
+        if (y > pageLimit) {
+            // Taller than a page: continue line by line on the following pages
+            y = extent.relativeY;
+            const QTextLayout *layout = block.layout();
+            for (int line = 0; layout && line < layout->lineCount(); ++line) {
+                const int lineHeight = qCeil(layout->lineAt(line).height());
+                if (y > 0 && y + lineHeight > pageLimit) {
+                    newBreaks.append(PageBreak{blockNumber, line});
+                    y = 0;
+                }
+                y += lineHeight;
+            }
+        }
+    }
+
+    const bool breaksChanged = newBreaks != m_pageBreaks;
+    const QVector<ContinuationMarker> previousMarkers = m_continuationMarkers;
+    m_pageBreaks = newBreaks;
+    m_dirtyFirstBlock = -1;
+    m_dirtyLastBlock = -1;
+    rebuildContinuationMarkers(document);
+    if (extentsChanged || breaksChanged || m_continuationMarkers != previousMarkers) {
+        ++m_generation;
+    }
+    return walked;
+}
+
+void PaginationModel::rebuildContinuationMarkers(const QTextDocument *document)
+{
+    m_continuationMarkers.clear();
+
+    // A page holds at most one break, so each page gets at most one marker of each kind
+    for (int i = 0; i < m_pageBreaks.size(); ++i) {
+        const QTextBlock block = document->findBlockByNumber(m_pageBreaks.at(i).blockNumber);
+        if (block.userState() != kDialogueElementState) {
+            continue;
+        }
+        const int nextPageIndex = i + 1;
+        m_continuationMarkers.append(ContinuationMarker{nextPageIndex - 1, false, "(MORE)"});
+        m_continuationMarkers.append(ContinuationMarker{nextPageIndex, true, "(CONT'D)"});
+    }
+}
+
+int PaginationModel::pageForBlock(int blockNumber) const
+{
+    // Breaks at or before the block's first line
+    auto it = std::upper_bound(m_pageBreaks.cbegin(), m_pageBreaks.cend(), blockNumber,
+                               [](int number, const PageBreak &pageBreak) {
+                                   return number < pageBreak.blockNumber
+                                       || (number == pageBreak.blockNumber && pageBreak.firstLine > 0);
+                               });
+    return static_cast<int>(it - m_pageBreaks.cbegin());
+}
+
+int PaginationModel::firstBlockOfPage(int pageIndex) const
+{
+    if (pageIndex <= 0) {
+        return 0;
+    }
+    if (pageIndex > m_pageBreaks.size()) {
+        return -1;
+    }
+    return m_pageBreaks.at(pageIndex - 1).blockNumber;
+}
+
+int PaginationModel::blockHeight(int blockNumber) const
+{
+    if (blockNumber < 0 || blockNumber >= m_blockExtents.size()) {
+        return 0;
+    }
+    return qMax(0, m_blockExtents.at(blockNumber).height);
+}
+
+int PaginationModel::blockSpaceBefore(int blockNumber) const
+{
+    if (blockNumber < 0 || blockNumber >= m_blockExtents.size()) {
+        return 0;
+    }
+    return m_blockExtents.at(blockNumber).spaceBefore;
+}
+
+int PaginationModel::blockRelativeY(int blockNumber) const
+{
+    if (blockNumber < 0 || blockNumber >= m_blockExtents.size()) {
+        return 0;
+    }
+    return m_blockExtents.at(blockNumber).relativeY;
+}
+
+int PaginationModel::blockTop(int blockNumber) const
+{
+    return pageYOffset(pageForBlock(blockNumber)) + blockRelativeY(blockNumber);
+}
+
+QVector<int> PaginationModel::blockSplitLines(int blockNumber) const
+{
+    QVector<int> lines;
+    auto it = std::upper_bound(m_pageBreaks.cbegin(), m_pageBreaks.cend(), blockNumber,
+                               [](int number, const PageBreak &pageBreak) {
+                                   return number < pageBreak.blockNumber
+                                       || (number == pageBreak.blockNumber && pageBreak.firstLine > 0);
+                               });
+    for (; it != m_pageBreaks.cend() && it->blockNumber == blockNumber; ++it) {
+        lines.append(it->firstLine);
+    }
+    return lines;
+}
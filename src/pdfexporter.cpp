@@ -1,5 +1,6 @@
 #include "pdfexporter.h"
-#include "scripteditor.h"
+#include "paginationmodel.h"
+#include "screenplaydocumentlayout.h"
 
 #include <QAbstractTextDocumentLayout>
 #include <QMarginsF>
@@ -9,71 +10,11 @@
 #include <QPdfWriter>
 #include <QTextBlock>
 #include <QTextDocument>
-#include <QTextLayout>
 #include <QStringList>
-#include <QSet>
 #include <QtMath>
 
 namespace PdfExporter {
 
-namespace {
-struct PdfContinuationMarker {
-    int pageIndex = 0;
-    bool isTop = false;
-    QString text;
-};
-
-QVector<PdfContinuationMarker> buildContinuationMarkers(QTextDocument *document, const Settings &settings)
-{
-    QVector<PdfContinuationMarker> markers;
-    if (!document) {
-        return markers;
-    }
-
-    QSet<QString> markerKeys;
-    const int printableH = settings.printableHeightPx;
-    const int pageAdvance = settings.printableHeightPx + settings.pageGapPx;
-    int pageStartY = 0;
-    int naturalY = 0;
-
-    QTextBlock block = document->begin();
-    while (block.isValid()) {
-        QTextLayout *layout = block.layout();
-        const int blockHeight = static_cast<int>(std::ceil(layout->boundingRect().height()));
-        const int blockTopMargin = static_cast<int>(block.blockFormat().topMargin());
-        const int posInPage = (naturalY - pageStartY) + blockTopMargin;
-
-        if (posInPage + blockHeight > printableH && posInPage > 0) {
-            if (block.userState() == static_cast<int>(ScriptEditor::Dialogue)) {
-                const int previousPageIndex = pageStartY / pageAdvance;
-                const int nextPageIndex = previousPageIndex + 1;
-
-                const QString lowerKey = QString("%1:%2").arg(previousPageIndex).arg("MORE");
-                if (!markerKeys.contains(lowerKey)) {
-                    markerKeys.insert(lowerKey);
-                    markers.append(PdfContinuationMarker{previousPageIndex, false, "(MORE)"});
-                }
-
-                const QString upperKey = QString("%1:%2").arg(nextPageIndex).arg("CONTD");
-                if (!markerKeys.contains(upperKey)) {
-                    markerKeys.insert(upperKey);
-                    markers.append(PdfContinuationMarker{nextPageIndex, true, "(CONT'D)"});
-                }
-            }
-
-            pageStartY += pageAdvance;
-            naturalY = pageStartY + blockTopMargin + blockHeight;
-        } else {
-            naturalY += blockTopMargin + blockHeight;
-        }
-
-        block = block.next();
-    }
-
-    return markers;
-}
-}
-
 bool exportDocumentToPdf(QTextDocument *document, const QString &filePath, const Settings &settings)
 {
     if (!document || settings.printableWidthPx <= 0 || settings.printableHeightPx <= 0) {
@@ -96,7 +37,26 @@ bool exportDocumentToPdf(QTextDocument *document, const QString &filePath, const
     qreal scaleX = static_cast<qreal>(paintRect.width()) / settings.printableWidthPx;
     qreal scaleY = static_cast<qreal>(paintRect.height()) / settings.printableHeightPx;
     qreal scale = qMin(scaleX, scaleY);
-    const QVector<PdfContinuationMarker> continuationMarkers = buildContinuationMarkers(document, settings);
+
+    // A document laid out by ScreenplayDocumentLayout is already placed on pages. Anything
+    // else is paginated here and each page is cut at the first block that starts it.
+    const auto *pagedLayout = qobject_cast<ScreenplayDocumentLayout *>(document->documentLayout());
+    PaginationModel localPagination;
+    const PaginationModel *pagination = settings.pagination;
+    if (!pagination && pagedLayout) {
+        pagination = &pagedLayout->pagination();
+    }
+    if (!pagination) {
+        const int pageHeight = settings.pageHeightPx > 0
+            ? settings.pageHeightPx
+            : settings.printableHeightPx + 2 * settings.topMarginPx;
+        document->documentLayout()->documentSize(); // Make sure every block has its lines
+        localPagination.setPageMetrics(pageHeight, settings.pageGapPx, settings.printableHeightPx);
+        localPagination.invalidate(document->blockCount());
+        localPagination.update(document);
+        pagination = &localPagination;
+    }
+    const QVector<PaginationModel::ContinuationMarker> &continuationMarkers = pagination->continuationMarkers();
 
     const int bodyPages = qMax(1, settings.pageCount);
     const bool hasTitlePage = settings.documentSettings.hasTitlePage;
@@ -172,23 +132,12 @@ bool exportDocumentToPdf(QTextDocument *document, const QString &filePath, const
         painter.scale(scale, scale);
 
         int pageContentStart = 0;
-        if (bodyPageIndex > 0) {
-            int currentY = 0;
-            QTextBlock block = document->begin();
-            while (block.isValid()) {
-                QTextLayout *layout = block.layout();
-                int blockHeight = static_cast<int>(std::ceil(layout->boundingRect().height()));
-                int blockTopMargin = static_cast<int>(block.blockFormat().topMargin());
-                int contentStartY = currentY + blockTopMargin;
-
-                int expectedPageStart = (settings.printableHeightPx + settings.pageGapPx) * bodyPageIndex;
-                if (contentStartY >= expectedPageStart) {
-                    pageContentStart = contentStartY;
-                    break;
-                }
-
-                currentY += blockTopMargin + blockHeight;
-                block = block.next();
+        if (bodyPageIndex > 0 && pagedLayout) {
+            pageContentStart = pagination->pageYOffset(bodyPageIndex);
+        } else if (bodyPageIndex > 0) {
+            const QTextBlock firstBlock = document->findBlockByNumber(pagination->firstBlockOfPage(bodyPageIndex));
+            if (firstBlock.isValid()) {
+                pageContentStart = static_cast<int>(document->documentLayout()->blockBoundingRect(firstBlock).top());
             }
         }
 
@@ -221,7 +170,7 @@ bool exportDocumentToPdf(QTextDocument *document, const QString &filePath, const
             painter.restore();
         }
 
-        for (const PdfContinuationMarker &marker : continuationMarkers) {
+        for (const PaginationModel::ContinuationMarker &marker : continuationMarkers) {
             if (marker.pageIndex != bodyPageIndex) {
                 continue;
             }
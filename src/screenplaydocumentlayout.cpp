@@ -0,0 +1,267 @@
+#include "screenplaydocumentlayout.h"
+#include "latencytrace.h"
+#include <QPainter>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QTextFrame>
+#include <QTextLayout>
+#include <QtMath>
+#include <climits>
+
+ScreenplayDocumentLayout::ScreenplayDocumentLayout(QTextDocument *document)
+    : QAbstractTextDocumentLayout(document)
+{
+}
+
+void ScreenplayDocumentLayout::setPageMetrics(int pageHeight, int pageGap, int printableHeight)
+{
+    const int generation = m_pagination.generation();
+    m_pagination.setPageMetrics(pageHeight, pageGap, printableHeight);
+    if (m_pagination.generation() != generation) {
+        relayout();
+    }
+}
+
+qreal ScreenplayDocumentLayout::textWidth() const
+{
+    return document()->textWidth();
+}
+
+void ScreenplayDocumentLayout::documentChanged(int from, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved);
+    m_pagination.contentsChanged(document(), from, charsAdded);
+    relayout();
+}
+
+void ScreenplayDocumentLayout::relayout()
+{
+    LatencyTrace::Scope trace(LatencyTrace::Layout);
+    QTextDocument *doc = document();
+    if (m_pagination.blockCount() != doc->blockCount()) {
+        m_pagination.invalidate(doc->blockCount());
+    }
+
+    // Only edited blocks need their text wrapped again; the page walk then
+    // decides where they and the blocks after them land
+    const PaginationModel::BlockRange dirty = m_pagination.dirtyBlocks();
+    if (dirty.isEmpty()) {
+        return;
+    }
+    QTextBlock block = doc->findBlockByNumber(dirty.firstBlock);
+    for (int blockNumber = dirty.firstBlock; block.isValid() && blockNumber <= dirty.lastBlock;
+         block = block.next(), ++blockNumber) {
+        layoutBlockText(block);
+    }
+
+    const PaginationModel::BlockRange walked = m_pagination.update(doc);
+    if (!walked.isEmpty()) {
+        block = doc->findBlockByNumber(walked.firstBlock);
+        for (int blockNumber = walked.firstBlock; block.isValid() && blockNumber <= walked.lastBlock;
+             block = block.next(), ++blockNumber) {
+            positionBlockLines(block, blockNumber);
+        }
+    }
+
+    const QRectF lastRect = blockBoundingRect(doc->lastBlock());
+    const QSizeF oldSize = m_documentSize;
+    m_documentSize = QSizeF(qMax<qreal>(0, textWidth()), lastRect.bottom());
+    if (m_documentSize != oldSize) {
+        emit documentSizeChanged(m_documentSize);
+    }
+
+    const qreal updateTop = walked.isEmpty() ? 0 : m_pagination.blockTop(walked.firstBlock);
+    emit update(QRectF(0, updateTop, 1000000000., 1000000000.));
+    emit paginationChanged();
+}
+
+void ScreenplayDocumentLayout::layoutBlockText(const QTextBlock &block)
+{
+    QTextDocument *doc = document();
+    QTextLayout *layout = block.layout();
+    const QTextBlockFormat format = block.blockFormat();
+
+    QTextOption option = doc->defaultTextOption();
+    option.setTextDirection(block.textDirection());
+    option.setTabs(format.tabPositions());
+    if (format.hasProperty(QTextFormat::BlockAlignment)) {
+        option.setAlignment(format.alignment());
+    }
+    layout->setTextOption(option);
+
+    const qreal left = format.leftMargin() + format.indent() * doc->indentWidth();
+    const qreal available = textWidth() > 0 ? textWidth() : qreal(INT_MAX);
+    const qreal width = qMax<qreal>(1, available - left - format.rightMargin());
+
+    // Lines are stacked on whole pixels so they match the heights the page walk adds up
+    layout->beginLayout();
+    qreal y = 0;
+    while (block.isVisible()) {
+        QTextLine line = layout->createLine();
+        if (!line.isValid()) {
+            break;
+        }
+        const qreal indent = line.lineNumber() == 0 ? format.textIndent() : 0;
+        line.setLineWidth(width - indent);
+        line.setPosition(QPointF(left + indent, y));
+        y += qCeil(line.height());
+    }
+    layout->endLayout();
+    QTextBlock(block).setLineCount(layout->lineCount());
+}
+
+void ScreenplayDocumentLayout::positionBlockLines(const QTextBlock &block, int blockNumber)
+{
+    QTextLayout *layout = block.layout();
+    const QVector<int> splitLines = m_pagination.blockSplitLines(blockNumber);
+    const int blockTop = m_pagination.blockTop(blockNumber);
+    int page = m_pagination.pageForBlock(blockNumber);
+    int nextSplit = 0;
+    qreal y = 0;
+
+    // A line that starts a new page jumps over the rest of the page and the gap
+    for (int i = 0; i < layout->lineCount(); ++i) {
+        QTextLine line = layout->lineAt(i);
+        if (nextSplit < splitLines.size() && splitLines.at(nextSplit) == i) {
+            ++nextSplit;
+            ++page;
+            y = m_pagination.pageYOffset(page) - blockTop;
+        }
+        line.setPosition(QPointF(line.position().x(), y));
+        y += qCeil(line.height());
+    }
+}
+
+int ScreenplayDocumentLayout::blockNumberAtY(qreal y) const
+{
+    // Last block whose content starts at or above y
+    int low = 0;
+    int high = m_pagination.blockCount() - 1;
+    int found = 0;
+    while (low <= high) {
+        const int mid = (low + high) / 2;
+        if (m_pagination.blockTop(mid) <= y) {
+            found = mid;
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return found;
+}
+
+void ScreenplayDocumentLayout::draw(QPainter *painter, const PaintContext &context)
+{
+    QTextDocument *doc = document();
+    const QRectF clip = context.clip;
+    const QVariant cursorWidthProperty = property("cursorWidth");
+    const int cursorWidth = cursorWidthProperty.isValid() ? cursorWidthProperty.toInt() : 1;
+
+    painter->setPen(context.palette.color(QPalette::Text));
+
+    QTextBlock block = doc->findBlockByNumber(clip.isValid() ? blockNumberAtY(clip.top()) : 0);
+    for (; block.isValid(); block = block.next()) {
+        const QRectF rect = blockBoundingRect(block);
+        if (clip.isValid() && rect.top() > clip.bottom()) {
+            break;
+        }
+        if (!block.isVisible() || (clip.isValid() && rect.bottom() < clip.top())) {
+            continue;
+        }
+
+        QTextLayout *layout = block.layout();
+        const int blockPosition = block.position();
+        const int blockLength = block.length();
+
+        QVector<QTextLayout::FormatRange> selections;
+        for (const Selection &selection : context.selections) {
+            const int selectionStart = selection.cursor.selectionStart() - blockPosition;
+            const int selectionEnd = selection.cursor.selectionEnd() - blockPosition;
+            if (selectionStart < blockLength && selectionEnd > 0 && selectionEnd > selectionStart) {
+                QTextLayout::FormatRange range;
+                range.start = selectionStart;
+                range.length = selectionEnd - selectionStart;
+                range.format = selection.format;
+                selections.append(range);
+            } else if (!selection.cursor.hasSelection()
+                       && selection.format.hasProperty(QTextFormat::FullWidthSelection)
+                       && block.contains(selection.cursor.position())) {
+                // Current-line highlight: select the visual line under the cursor
+                const QTextLine line = layout->lineForTextPosition(selection.cursor.position() - blockPosition);
+                QTextLayout::FormatRange range;
+                range.start = line.textStart();
+                range.length = qMax(1, line.textLength());
+                range.format = selection.format;
+                selections.append(range);
+            }
+        }
+
+        layout->draw(painter, rect.topLeft(), selections, clip);
+        if (context.cursorPosition >= blockPosition && context.cursorPosition < blockPosition + blockLength) {
+            layout->drawCursor(painter, rect.topLeft(), context.cursorPosition - blockPosition, cursorWidth);
+        }
+    }
+}
+
+int ScreenplayDocumentLayout::hitTest(const QPointF &point, Qt::HitTestAccuracy accuracy) const
+{
+    Q_UNUSED(accuracy);
+    const QTextBlock block = document()->findBlockByNumber(blockNumberAtY(point.y()));
+    if (!block.isValid()) {
+        return -1;
+    }
+
+    const QTextLayout *layout = block.layout();
+    const QPointF pos = point - blockBoundingRect(block).topLeft();
+    int offset = 0;
+    for (int i = 0; i < layout->lineCount(); ++i) {
+        const QTextLine line = layout->lineAt(i);
+        const QRectF lineRect = line.naturalTextRect();
+        if (lineRect.top() > pos.y()) {
+            offset = qMin(offset, line.textStart());
+        } else if (lineRect.bottom() <= pos.y()) {
+            offset = qMax(offset, line.textStart() + line.textLength());
+        } else {
+            offset = line.xToCursor(pos.x());
+            break;
+        }
+    }
+    return block.position() + offset;
+}
+
+int ScreenplayDocumentLayout::pageCount() const
+{
+    return m_pagination.pageCount();
+}
+
+QSizeF ScreenplayDocumentLayout::documentSize() const
+{
+    return m_documentSize;
+}
+
+QRectF ScreenplayDocumentLayout::frameBoundingRect(QTextFrame *frame) const
+{
+    if (frame != document()->rootFrame()) {
+        return QRectF();
+    }
+    return QRectF(QPointF(0, 0), m_documentSize);
+}
+
+QRectF ScreenplayDocumentLayout::blockBoundingRect(const QTextBlock &block) const
+{
+    if (!block.isValid()) {
+        return QRectF();
+    }
+    const int blockNumber = block.blockNumber();
+    if (blockNumber >= m_pagination.blockCount()) {
+        return QRectF();
+    }
+
+    qreal height = 0;
+    const QTextLayout *layout = block.layout();
+    if (layout && layout->lineCount() > 0) {
+        const QTextLine lastLine = layout->lineAt(layout->lineCount() - 1);
+        height = lastLine.y() + qCeil(lastLine.height());
+    }
+    return QRectF(0, m_pagination.blockTop(blockNumber), qMax<qreal>(0, textWidth()), height);
+}
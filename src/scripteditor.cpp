@@ -1,5 +1,9 @@
 #include "scripteditor.h"
+#include "latencytrace.h"
+#include "linegridpaginator.h"
+#include "mappedspellchecker.h"
 #include "spellcheckservice.h"
+#include "texttokenizer.h"
 #ifdef Q_OS_WIN
 #include "windowsspellchecker.h"
 #endif
@@ -10,11 +14,16 @@
 #include <QTextDocument>
 #include <QKeyEvent>
 #include <QScrollBar>
+#include <QSignalBlocker>
 #include <QDebug>
 #include <QPainter>
 #include <QAbstractTextDocumentLayout>
 #include <QTextLayout>
 #include <QMouseEvent>
+#include <QPaintEvent>
+#include <QStyleHints>
+#include <QTimerEvent>
+#include <QtMath>
 #include <QFocusEvent>
 #include <QClipboard>
 #include <QCompleter>
@@ -26,6 +35,8 @@
 #include <QContextMenuEvent>
 #include <QMenu>
 #include <QTimer>
+#include <QDataStream>
+#include <algorithm>
 #include "scripteditor_undo.h"
 
 using ScriptEditorUndo::CompoundCommand;
@@ -33,6 +44,87 @@ using ScriptEditorUndo::DeleteTextCommand;
 using ScriptEditorUndo::FormatCommand;
 using ScriptEditorUndo::InsertTextCommand;
 using ScriptEditorUndo::normalizeSelectedText;
+using ScriptEditorUndo::ReplaceAllCommand;
+
+namespace {
+
+using SpellWordIndex = QHash<QString, QSet<QTextBlockUserData *>>;
+
+// Spellcheck results cached on the block they came from. They stay valid while the block's
+// text hashes the same; adding a word to the dictionary edits them in place. Each cache is
+// listed in the editor's word index under its misspelled words until the block goes away.
+class SpellBlockData : public QTextBlockUserData {
+public:
+    ~SpellBlockData() override { unindex(); }
+
+    void unindex()
+    {
+        if (!index) {
+            return;
+        }
+        for (const QString &word : words) {
+            const auto it = index->find(word);
+            if (it != index->end()) {
+                it->remove(this);
+                if (it->isEmpty()) {
+                    index->erase(it);
+                }
+            }
+        }
+    }
+
+    QTextBlock block;
+    SpellWordIndex *index = nullptr; // Cleared when the editor goes first
+    size_t textHash = 0;
+    QVector<HighlightLayer::Range> misspellings; // Relative to the block start
+    QStringList words; // Lower-cased, one per misspelling
+};
+
+const SpellBlockData *cachedMisspellings(const QTextBlock &block, size_t textHash)
+{
+    const auto *data = dynamic_cast<const SpellBlockData *>(block.userData());
+    if (data && data->textHash == textHash) {
+        return data;
+    }
+    return nullptr;
+}
+
+void cacheMisspellings(QTextBlock block, const QString &text, size_t textHash,
+                       const QVector<HighlightLayer::Range> &misspellings, SpellWordIndex &index)
+{
+    auto *data = dynamic_cast<SpellBlockData *>(block.userData());
+    if (!data) {
+        data = new SpellBlockData;
+        block.setUserData(data);
+    }
+    data->unindex();
+    data->block = block;
+    data->index = &index;
+    data->textHash = textHash;
+    data->misspellings = misspellings;
+    data->words.clear();
+    for (const HighlightLayer::Range &range : misspellings) {
+        const QString word = text.mid(range.start, range.length).toLower();
+        data->words.append(word);
+        index[word].insert(data);
+    }
+}
+
+QVector<HighlightLayer::Range> checkBlockText(const AbstractSpellChecker &checker, const QString &text)
+{
+    QVector<HighlightLayer::Range> ranges;
+    const QList<Misspelling> checked = checker.checkText(text);
+    for (const Misspelling &item : checked) {
+        if (item.length > 0) {
+            ranges.append({item.start, item.length});
+        }
+    }
+    std::sort(ranges.begin(), ranges.end(),
+              [](const HighlightLayer::Range &a, const HighlightLayer::Range &b) { return a.start < b.start; });
+    return ranges;
+}
+
+} // namespace
 
 ScriptEditor::ScriptEditor(QWidget *parent)
     : QTextEdit(parent)
@@ -61,6 +153,10 @@ ScriptEditor::ScriptEditor(QWidget *parent)
     f.setStyleHint(QFont::TypeWriter);
     setFont(f);
 
+    // Element margins are in inches; track the DPI instead of asking the screen per block
+    watchPrimaryScreen(QGuiApplication::primaryScreen());
+    connect(qGuiApp, &QGuiApplication::primaryScreenChanged, this, &ScriptEditor::watchPrimaryScreen);
+
     // Line wrap will be set by PageView based on printable width
     setLineWrapMode(QTextEdit::FixedPixelWidth);
 
@@ -105,8 +201,10 @@ ScriptEditor::ScriptEditor(QWidget *parent)
     });
 
     // Emit undo/redo availability changes from the custom undo stack
-    connect(&m_undoStack, &QUndoStack::canUndoChanged, this, &ScriptEditor::undoAvailableChanged);
-    connect(&m_undoStack, &QUndoStack::canRedoChanged, this, &ScriptEditor::redoAvailableChanged);
+    connect(&m_undoHistory, &UndoHistory::canUndoChanged, this, &ScriptEditor::undoAvailableChanged);
+    connect(&m_undoHistory, &UndoHistory::canRedoChanged, this, &ScriptEditor::redoAvailableChanged);
+    m_undoHistory.setCheckpointCapture([this] { return captureHistorySnapshot(); });
+    m_undoHistory.setCheckpointRestore([this](const QByteArray &snapshot) { restoreHistorySnapshot(snapshot); });
 
     // Start with Scene Heading element without pushing undo state
     applyFormatDirect(SceneHeading);
@@ -123,27 +221,80 @@ ScriptEditor::ScriptEditor(QWidget *parent)
             m_spellChecker.reset(wsc);
         } else {
             delete wsc;
-            m_spellChecker = std::make_unique<BasicSpellChecker>();
+            m_spellChecker = std::make_unique<BasicSpellChecker>(UserDictionary::defaultPath());
         }
     }
 #else
-    m_spellChecker = std::make_unique<BasicSpellChecker>();
+    {
+        // A compiled dictionary when one is installed, else the small built-in word list
+        auto mapped = std::make_unique<MappedDictionarySpellChecker>(MappedDictionarySpellChecker::defaultDictionaryPath(),
+                                                                     UserDictionary::defaultPath());
+        if (mapped->isAvailable()) {
+            m_spellChecker = std::move(mapped);
+        } else {
+            m_spellChecker = std::make_unique<BasicSpellChecker>(UserDictionary::defaultPath());
+        }
+    }
 #endif
     m_spellcheckTimer = new QTimer(this);
     m_spellcheckTimer->setSingleShot(true);
     m_spellcheckTimer->setInterval(250);
+    m_spellPool.setMaxThreadCount(1);
     connect(m_spellcheckTimer, &QTimer::timeout, this, &ScriptEditor::refreshSpellcheck);
 
-    connect(document(), &QTextDocument::contentsChanged, this, [this] {
-        rebuildFindMatches();
-        scheduleSpellcheckRefresh();
+    QTextCharFormat misspelledFormat;
+    misspelledFormat.setUnderlineColor(QColor("#E06C75"));
+    misspelledFormat.setUnderlineStyle(QTextCharFormat::SpellCheckUnderline);
+    m_highlights.setFormat(HighlightLayer::Spelling, misspelledFormat);
+
+    QTextCharFormat matchFormat;
+    matchFormat.setBackground(QColor("#7B93C466"));
+    matchFormat.setForeground(QColor("#101319"));
+    QTextCharFormat activeMatchFormat;
+    activeMatchFormat.setBackground(QColor("#98B7F0"));
+    activeMatchFormat.setForeground(QColor("#101319"));
+    m_highlights.setFormat(HighlightLayer::FindMatch, matchFormat, activeMatchFormat);
+
+    // Highlights follow each edit: shifted past it, find matches rescanned only in the blocks it touched
+    connect(document(), &QTextDocument::contentsChange, this, &ScriptEditor::updateHighlightRanges);
+    connect(document(), &QTextDocument::contentsChange, this, &ScriptEditor::recordTransactionChange);
+    connect(document(), &QTextDocument::contentsChanged, this, &ScriptEditor::scheduleSpellcheckRefresh);
+
+    // The text control invalidates in page units; when zoomed, repaint the visible view instead
+    connect(document(), &QTextDocument::contentsChanged, this, &ScriptEditor::updateZoomedViewport);
+    connect(this, &QTextEdit::selectionChanged, this, &ScriptEditor::updateZoomedViewport);
+    connect(this, &QTextEdit::cursorPositionChanged, this, [this] {
+        updateZoomedViewport();
+        restartCaretBlink();
     });
 
+    // PageView does all scrolling. A zoomed-out viewport is smaller than the page-unit
+    // document, so keep QTextEdit from scrolling its contents on its own.
+    for (QScrollBar *bar : {verticalScrollBar(), horizontalScrollBar()}) {
+        connect(bar, &QScrollBar::rangeChanged, bar, [bar] { bar->setRange(0, 0); });
+    }
+
+    markSpellcheckDirty(0, document()->characterCount());
     scheduleSpellcheckRefresh();
 }
 
+ScriptEditor::~ScriptEditor()
+{
+    // A background pass reads the checker, so stop it before the members go
+    ++m_spellGeneration;
+    m_spellPool.waitForDone();
+
+    // The document and its block caches outlive the word index
+    for (const QSet<QTextBlockUserData *> &entries : std::as_const(m_spellWordIndex)) {
+        for (QTextBlockUserData *entry : entries) {
+            static_cast<SpellBlockData *>(entry)->index = nullptr;
+        }
+    }
+}
+
 void ScriptEditor::keyPressEvent(QKeyEvent *e)
 {
+    LatencyTrace::Scope trace(LatencyTrace::KeyPress);
     if (m_completer && m_completer->popup()->isVisible()) {
         switch (e->key()) {
         case Qt::Key_Return:
@@ -168,13 +319,13 @@ void ScriptEditor::keyPressEvent(QKeyEvent *e)
 
     if (e->matches(QKeySequence::Undo)) {
         hideCompletionPopup();
-        m_undoStack.undo();
+        undo();
         return;
     }
 
     if (e->matches(QKeySequence::Redo)) {
         hideCompletionPopup();
-        m_undoStack.redo();
+        redo();
         return;
     }
 
@@ -191,9 +342,9 @@ void ScriptEditor::keyPressEvent(QKeyEvent *e)
             QString selText = normalizeSelectedText(cursor.selectedText());
             new DeleteTextCommand(this, selStart, selText, UndoGroupType::Bulk, false, false, cmd);
             new InsertTextCommand(this, selStart, text, UndoGroupType::Bulk, false, cmd);
-            m_undoStack.push(cmd);
+            pushCommand(cmd);
         } else {
-            m_undoStack.push(new InsertTextCommand(this, insertPos, text, UndoGroupType::Bulk, false));
+            pushCommand(new InsertTextCommand(this, insertPos, text, UndoGroupType::Bulk, false));
         }
         return;
     }
@@ -207,7 +358,7 @@ void ScriptEditor::keyPressEvent(QKeyEvent *e)
         QString selText = normalizeSelectedText(cursor.selectedText());
         QGuiApplication::clipboard()->setText(selText);
         int selStart = cursor.selectionStart();
-        m_undoStack.push(new DeleteTextCommand(this, selStart, selText, UndoGroupType::Bulk, false, false));
+        pushCommand(new DeleteTextCommand(this, selStart, selText, UndoGroupType::Bulk, false, false));
         return;
     }
 
@@ -263,7 +414,7 @@ void ScriptEditor::keyPressEvent(QKeyEvent *e)
         int newBlockPos = insertPos + 1;
         new FormatCommand(this, newBlockPos, newBlock, newChar, static_cast<int>(next), cmdParent);
 
-        m_undoStack.push(cmdParent);
+        pushCommand(cmdParent);
         return;
     }
 
@@ -275,7 +426,7 @@ void ScriptEditor::keyPressEvent(QKeyEvent *e)
         if (hasSelection) {
             int selStart = cursor.selectionStart();
             QString selText = normalizeSelectedText(cursor.selectedText());
-            m_undoStack.push(new DeleteTextCommand(this, selStart, selText, UndoGroupType::Bulk, false, false));
+            pushCommand(new DeleteTextCommand(this, selStart, selText, UndoGroupType::Bulk, false, false));
             return;
         }
 
@@ -301,7 +452,7 @@ void ScriptEditor::keyPressEvent(QKeyEvent *e)
         bool backspace = (e->key() == Qt::Key_Backspace);
         int delPos = backspace ? pos - 1 : pos;
 
-        m_undoStack.push(new DeleteTextCommand(this, delPos, selText, type, allowMerge, backspace));
+        pushCommand(new DeleteTextCommand(this, delPos, selText, type, allowMerge, backspace));
         return;
     }
 
@@ -322,7 +473,7 @@ void ScriptEditor::keyPressEvent(QKeyEvent *e)
                 insertPos = selStart;
             }
             new InsertTextCommand(this, insertPos, text, UndoGroupType::Bulk, false, cmdParent);
-            m_undoStack.push(cmdParent);
+            pushCommand(cmdParent);
             return;
         }
 
@@ -341,7 +492,7 @@ void ScriptEditor::keyPressEvent(QKeyEvent *e)
         bool allowMerge = completionSuffix.isEmpty() && (type == UndoGroupType::Word ||
                    type == UndoGroupType::Whitespace ||
                    type == UndoGroupType::Punctuation);
-        m_undoStack.push(new InsertTextCommand(this, insertPos, insertText, type, allowMerge));
+        pushCommand(new InsertTextCommand(this, insertPos, insertText, type, allowMerge));
 
         if (!completionSuffix.isEmpty()) {
             QTextCursor completionCursor = textCursor();
@@ -365,14 +516,156 @@ void ScriptEditor::keyPressEvent(QKeyEvent *e)
     QTextEdit::keyPressEvent(e);
 }
 
+QMouseEvent ScriptEditor::toPageUnits(const QMouseEvent *e) const
+{
+    return QMouseEvent(e->type(), e->position() / m_zoomFactor, e->scenePosition(), e->globalPosition(),
+                       e->button(), e->buttons(), e->modifiers(), e->pointingDevice());
+}
+
 void ScriptEditor::mousePressEvent(QMouseEvent *e)
 {
-    QTextEdit::mousePressEvent(e);
+    QMouseEvent mapped = toPageUnits(e);
+    QTextEdit::mousePressEvent(&mapped);
+    e->setAccepted(mapped.isAccepted());
+}
+
+void ScriptEditor::mouseMoveEvent(QMouseEvent *e)
+{
+    QMouseEvent mapped = toPageUnits(e);
+    QTextEdit::mouseMoveEvent(&mapped);
+    e->setAccepted(mapped.isAccepted());
+}
+
+void ScriptEditor::mouseReleaseEvent(QMouseEvent *e)
+{
+    QMouseEvent mapped = toPageUnits(e);
+    QTextEdit::mouseReleaseEvent(&mapped);
+    e->setAccepted(mapped.isAccepted());
+}
+
+void ScriptEditor::mouseDoubleClickEvent(QMouseEvent *e)
+{
+    QMouseEvent mapped = toPageUnits(e);
+    QTextEdit::mouseDoubleClickEvent(&mapped);
+    e->setAccepted(mapped.isAccepted());
+}
+
+void ScriptEditor::paintEvent(QPaintEvent *e)
+{
+    // The document is laid out once in page units; zoom only scales the painter
+    QPainter p(viewport());
+    const QRectF exposed(e->rect());
+    p.setClipRect(exposed);
+    p.scale(m_zoomFactor, m_zoomFactor);
+
+    QAbstractTextDocumentLayout::PaintContext context;
+    context.palette = palette();
+    context.clip = QRectF(exposed.topLeft() / m_zoomFactor, exposed.size() / m_zoomFactor);
+    context.cursorPosition = (m_caretVisible && hasFocus() && !isReadOnly()) ? textCursor().position() : -1;
+
+    // Only highlights in the blocks being painted become selections
+    QAbstractTextDocumentLayout *layout = document()->documentLayout();
+    const int topHit = layout->hitTest(context.clip.topLeft(), Qt::FuzzyHit);
+    const int bottomHit = layout->hitTest(context.clip.bottomRight(), Qt::FuzzyHit);
+    const int visibleStart = topHit >= 0 ? document()->findBlock(topHit).position() : 0;
+    const QTextBlock lastVisible = bottomHit >= 0 ? document()->findBlock(bottomHit) : QTextBlock();
+    const int visibleEnd = lastVisible.isValid() ? lastVisible.position() + lastVisible.length() : document()->characterCount();
+    m_highlights.appendSelections(document(), visibleStart, visibleEnd, context.selections);
+
+    const QList<QTextEdit::ExtraSelection> extras = extraSelections();
+    for (const QTextEdit::ExtraSelection &extra : extras) {
+        QAbstractTextDocumentLayout::Selection selection;
+        selection.cursor = extra.cursor;
+        selection.format = extra.format;
+        context.selections.append(selection);
+    }
+    const QTextCursor cursor = textCursor();
+    if (cursor.hasSelection()) {
+        const QPalette::ColorGroup group = hasFocus() ? QPalette::Active : QPalette::Inactive;
+        QAbstractTextDocumentLayout::Selection selection;
+        selection.cursor = cursor;
+        selection.format.setBackground(context.palette.brush(group, QPalette::Highlight));
+        selection.format.setForeground(context.palette.brush(group, QPalette::HighlightedText));
+        context.selections.append(selection);
+    }
+
+    layout->draw(&p, context);
+}
+
+void ScriptEditor::timerEvent(QTimerEvent *e)
+{
+    if (e->timerId() != m_caretBlinkTimer.timerId()) {
+        QTextEdit::timerEvent(e);
+        return;
+    }
+    m_caretVisible = !m_caretVisible;
+    viewport()->update(viewCursorRect().adjusted(-2, -2, 2, 2));
+}
+
+void ScriptEditor::restartCaretBlink()
+{
+    m_caretVisible = true;
+    const int flashTime = QGuiApplication::styleHints()->cursorFlashTime();
+    if (hasFocus() && flashTime > 0) {
+        m_caretBlinkTimer.start(flashTime / 2, this);
+    } else {
+        m_caretBlinkTimer.stop();
+    }
+    viewport()->update(viewCursorRect().adjusted(-2, -2, 2, 2));
+}
+
+void ScriptEditor::focusInEvent(QFocusEvent *e)
+{
+    QTextEdit::focusInEvent(e);
+    restartCaretBlink();
 }
 
 void ScriptEditor::focusOutEvent(QFocusEvent *e)
 {
     QTextEdit::focusOutEvent(e);
+    restartCaretBlink();
+}
+
+void ScriptEditor::changeEvent(QEvent *e)
+{
+    // Spacing above elements is measured in lines of the editor font, zoomInText() included
+    if (e->type() == QEvent::FontChange) {
+        invalidateFormatCache();
+    }
+    QTextEdit::changeEvent(e);
+}
+
+void ScriptEditor::setZoomFactor(qreal factor)
+{
+    if (qFuzzyCompare(factor, m_zoomFactor) || factor <= 0.0) {
+        return;
+    }
+    m_zoomFactor = factor;
+    viewport()->update();
+}
+
+void ScriptEditor::updateZoomedViewport()
+{
+    if (!qFuzzyCompare(m_zoomFactor, 1.0)) {
+        viewport()->update();
+    }
+}
+
+QRect ScriptEditor::viewCursorRect() const
+{
+    const QRect r = cursorRect();
+    return QRect(qFloor(r.x() * m_zoomFactor), qFloor(r.y() * m_zoomFactor),
+                 qCeil(r.width() * m_zoomFactor), qCeil(r.height() * m_zoomFactor));
+}
+
+QVariant ScriptEditor::inputMethodQuery(Qt::InputMethodQuery query) const
+{
+    const QVariant value = QTextEdit::inputMethodQuery(query);
+    if (query == Qt::ImCursorRectangle || query == Qt::ImAnchorRectangle) {
+        const QRectF r = value.toRectF();
+        return QRectF(r.topLeft() * m_zoomFactor, r.size() * m_zoomFactor);
+    }
+    return value;
 }
 
 void ScriptEditor::contextMenuEvent(QContextMenuEvent *event)
@@ -407,10 +700,7 @@ void ScriptEditor::contextMenuEvent(QContextMenuEvent *event)
 
             QAction *addToDictionaryAction = menu->addAction("Add to Dictionary");
             connect(addToDictionaryAction, &QAction::triggered, this, [this, token] {
-                if (m_spellChecker) {
-                    m_spellChecker->addWord(token);
-                    scheduleSpellcheckRefresh();
-                }
+                addWordToDictionary(token);
             });
         }
     }
@@ -421,8 +711,20 @@ void ScriptEditor::contextMenuEvent(QContextMenuEvent *event)
 
 double ScriptEditor::dpiX() const
 {
-    QScreen *screen = QGuiApplication::primaryScreen();
-    return screen ? screen->logicalDotsPerInchX() : 96.0;
+    return m_dpiX;
+}
+
+void ScriptEditor::watchPrimaryScreen(QScreen *screen)
+{
+    disconnect(m_screenDpiConnection);
+    m_dpiX = screen ? screen->logicalDotsPerInchX() : 96.0;
+    if (screen) {
+        m_screenDpiConnection = connect(screen, &QScreen::logicalDotsPerInchChanged, this, [this, screen] {
+            m_dpiX = screen->logicalDotsPerInchX();
+            invalidateFormatCache();
+        });
+    }
+    invalidateFormatCache();
 }
 
 double ScriptEditor::inchToPx(double inches) const
@@ -504,7 +806,7 @@ void ScriptEditor::showCompletionPopup(ElementType type, const QString &prefix)
     m_completionPrefix = prefix.toUpper();
     m_completionModel->setStringList(matches);
 
-    QRect popupRect = cursorRect();
+    QRect popupRect = viewCursorRect();
     popupRect.setWidth(220);
     m_completer->complete(popupRect);
 }
@@ -530,7 +832,7 @@ void ScriptEditor::insertChosenCompletion(const QString &completion)
     }
 
     const int insertPos = textCursor().position();
-    m_undoStack.push(new InsertTextCommand(this, insertPos, suffix, UndoGroupType::Bulk, false));
+    pushCommand(new InsertTextCommand(this, insertPos, suffix, UndoGroupType::Bulk, false));
     hideCompletionPopup();
 }
 
@@ -570,7 +872,7 @@ void ScriptEditor::applyFormat(ElementType type)
     QTextCharFormat cf;
     buildFormats(type, bf, cf);
     int blockPos = c.block().position();
-    m_undoStack.push(new FormatCommand(this, blockPos, bf, cf, static_cast<int>(type)));
+    pushCommand(new FormatCommand(this, blockPos, bf, cf, static_cast<int>(type)));
 }
 
 ScriptEditor::ElementType ScriptEditor::currentElement() const
@@ -592,13 +894,14 @@ void ScriptEditor::formatDocument()
     while (block.isValid()) {
         int state = block.userState();
         if (state >= 0 && state < ElementCount) {
-            cursor.setPosition(block.position());
-            ElementType type = static_cast<ElementType>(state);
-            QTextBlockFormat bf;
-            QTextCharFormat cf;
-            buildFormats(type, bf, cf);
-            cursor.setBlockFormat(bf);
-            cursor.setBlockCharFormat(cf);
+            // Blocks already in their element's format are left alone, so a freshly
+            // loaded script only relayouts the blocks that differ
+            const ElementFormats &formats = elementFormats(static_cast<ElementType>(state));
+            if (block.blockFormat() != formats.block || block.charFormat() != formats.chars) {
+                cursor.setPosition(block.position());
+                cursor.setBlockFormat(formats.block);
+                cursor.setBlockCharFormat(formats.chars);
+            }
         }
         block = block.next();
     }
@@ -608,13 +911,14 @@ void ScriptEditor::formatDocument()
 
 void ScriptEditor::undo()
 {
-    m_undoStack.undo();
+    EditTransaction transaction(this);
+    m_undoHistory.undo();
 }
 
 void ScriptEditor::clear()
 {
     QTextEdit::clear();
-    m_undoStack.clear();
+    m_undoHistory.clear();
     applyFormatDirect(SceneHeading);
     rebuildFindMatches();
     scheduleSpellcheckRefresh();
@@ -622,7 +926,153 @@ void ScriptEditor::clear()
 
 void ScriptEditor::redo()
 {
-    m_undoStack.redo();
+    EditTransaction transaction(this);
+    m_undoHistory.redo();
+}
+
+bool ScriptEditor::restoreHistoryPoint(int index)
+{
+    // The snapshot load and the replayed commands land in one edit block
+    EditTransaction transaction(this);
+    return m_undoHistory.restoreTo(index);
+}
+
+ScriptEditor::EditTransaction::EditTransaction(ScriptEditor *editor)
+    : m_editor(editor)
+{
+    m_editor->beginEditTransaction();
+}
+
+ScriptEditor::EditTransaction::~EditTransaction()
+{
+    m_editor->endEditTransaction();
+}
+
+void ScriptEditor::beginEditTransaction()
+{
+    if (m_transactionDepth++ > 0) {
+        return;
+    }
+    m_transactionRecord = EditRecord();
+    m_transactionEditBlock = QTextCursor(document());
+    m_transactionEditBlock.beginEditBlock();
+}
+
+void ScriptEditor::endEditTransaction()
+{
+    if (m_transactionDepth > 1) {
+        --m_transactionDepth;
+        return;
+    }
+
+    const QTextCursor before = textCursor();
+    {
+        // The document reports the whole block here, moving the editor's own cursor along
+        // the way; those intermediate signals are replaced by the ones below
+        const QSignalBlocker blocker(this);
+        m_transactionEditBlock.endEditBlock();
+        if (!m_transactionCursor.isNull()) {
+            setTextCursor(m_transactionCursor);
+        }
+    }
+    m_transactionDepth = 0;
+    m_transactionEditBlock = QTextCursor();
+    m_transactionCursor = QTextCursor();
+
+    EditRecord record = m_transactionRecord;
+    record.cursorPosition = textCursor().position();
+    record.element = currentElement();
+    if (record.start >= 0) {
+        emit textChanged();
+        emit findResultsChanged(m_activeFindIndex, m_findMatches.size());
+    }
+    // The blocker also swallowed these, and the zoomed viewport and Cut/Copy follow them
+    const QTextCursor after = textCursor();
+    if (after.selectionStart() != before.selectionStart() || after.selectionEnd() != before.selectionEnd()) {
+        emit selectionChanged();
+    }
+    if (after.hasSelection() != before.hasSelection()) {
+        emit copyAvailable(after.hasSelection());
+    }
+    // Also announces the element under the cursor
+    emit cursorPositionChanged();
+    emit editCommitted(record);
+}
+
+void ScriptEditor::recordTransactionChange(int position, int charsRemoved, int charsAdded)
+{
+    if (m_transactionDepth == 0) {
+        return;
+    }
+    EditRecord &record = m_transactionRecord;
+    const int delta = charsAdded - charsRemoved;
+    if (record.start < 0) {
+        record.start = position;
+        record.end = position + charsAdded;
+        return;
+    }
+    // Earlier spans are in pre-edit positions; move their end past this edit's growth
+    if (record.end >= position + charsRemoved) {
+        record.end += delta;
+    }
+    record.start = qMin(record.start, position);
+    record.end = qMax(record.end, position + charsAdded);
+}
+
+void ScriptEditor::placeCursor(const QTextCursor &cursor)
+{
+    if (m_transactionDepth > 0) {
+        m_transactionCursor = cursor;
+        return;
+    }
+    setTextCursor(cursor);
+}
+
+void ScriptEditor::pushCommand(QUndoCommand *command)
+{
+    EditTransaction transaction(this);
+    m_undoHistory.push(command);
+}
+
+QByteArray ScriptEditor::captureHistorySnapshot() const
+{
+    // Formats follow from each block's element type, so text and type are the whole state
+    QByteArray snapshot;
+    QDataStream out(&snapshot, QIODevice::WriteOnly);
+    out << qint32(document()->blockCount());
+    for (QTextBlock block = document()->begin(); block.isValid(); block = block.next()) {
+        out << qint8(block.userState()) << block.text();
+    }
+    return snapshot;
+}
+
+void ScriptEditor::restoreHistorySnapshot(const QByteArray &snapshot)
+{
+    QDataStream in(snapshot);
+    qint32 blockCount = 0;
+    in >> blockCount;
+
+    QTextCursor cursor(document());
+    cursor.select(QTextCursor::Document);
+    cursor.removeSelectedText();
+    for (qint32 i = 0; i < blockCount && in.status() == QDataStream::Ok; ++i) {
+        qint8 state = 0;
+        QString text;
+        in >> state >> text;
+        const ElementType type = (state >= 0 && state < ElementCount) ? static_cast<ElementType>(state) : Action;
+        QTextBlockFormat bf;
+        QTextCharFormat cf;
+        buildFormats(type, bf, cf);
+        if (i > 0) {
+            cursor.insertBlock(bf, cf);
+        } else {
+            cursor.setBlockFormat(bf);
+            cursor.setBlockCharFormat(cf);
+        }
+        cursor.insertText(text, cf);
+        cursor.block().setUserState(state);
+    }
+    placeCursor(cursor);
 }
 
 void ScriptEditor::zoomInText()
@@ -679,21 +1129,11 @@ bool ScriptEditor::findNext()
         return false;
     }
 
+    // First match at or after the cursor, wrapping to the top
     const int currentPos = textCursor().selectionEnd();
-    int nextIndex = 0;
-    for (int i = 0; i < m_findMatches.size(); ++i) {
-        if (m_findMatches[i].start >= currentPos) {
-            nextIndex = i;
-            break;
-        }
-    }
-
-    if (m_activeFindIndex >= 0 && m_activeFindIndex + 1 < m_findMatches.size()) {
-        if (m_findMatches[m_activeFindIndex].start < currentPos) {
-            nextIndex = m_activeFindIndex + 1;
-        }
-    }
-
+    const auto next = std::lower_bound(m_findMatches.cbegin(), m_findMatches.cend(), currentPos,
+                                       [](const Range &range, int pos) { return range.start < pos; });
+    const int nextIndex = static_cast<int>(next - m_findMatches.cbegin());
     applyFindMatchAtIndex(nextIndex % m_findMatches.size());
     return true;
 }
@@ -704,15 +1144,12 @@ bool ScriptEditor::findPrevious()
         return false;
     }
 
+    // Last match before the cursor, wrapping to the bottom
     const int currentPos = textCursor().selectionStart();
-    int prevIndex = m_findMatches.size() - 1;
-    for (int i = m_findMatches.size() - 1; i >= 0; --i) {
-        if (m_findMatches[i].start < currentPos) {
-            prevIndex = i;
-            break;
-        }
-    }
-
+    const auto next = std::lower_bound(m_findMatches.cbegin(), m_findMatches.cend(), currentPos,
+                                       [](const Range &range, int pos) { return range.start < pos; });
+    const int prevIndex = next == m_findMatches.cbegin() ? m_findMatches.size() - 1
+                                                        : static_cast<int>(next - m_findMatches.cbegin()) - 1;
     applyFindMatchAtIndex(prevIndex);
     return true;
 }
@@ -735,11 +1172,14 @@ void ScriptEditor::setSpellcheckEnabled(bool enabled)
 
     m_spellcheckEnabled = enabled;
     if (!m_spellcheckEnabled) {
+        cancelSpellcheckPass();
         m_spellingRanges.clear();
-        refreshExtraSelections();
+        refreshHighlights();
         return;
     }
 
+    // Block caches survive being switched off; only the ranges need collecting again
+    markSpellcheckDirty(0, document()->characterCount());
     scheduleSpellcheckRefresh();
 }
 
@@ -761,6 +1201,63 @@ QStringList ScriptEditor::spellcheckSuggestions(const QString &word) const
     return m_spellChecker->suggestionsFor(word);
 }
 
+void ScriptEditor::addWordToDictionary(const QString &word)
+{
+    const QString normalized = word.trimmed().toLower();
+    if (!m_spellChecker || normalized.isEmpty()) {
+        return;
+    }
+    LatencyTrace::Scope trace(LatencyTrace::Spellcheck);
+    m_spellChecker->addWord(normalized);
+    // Blocks a pass in flight checked before the word was known are checked again
+    cancelSpellcheckPass();
+
+    // Only the blocks the index lists can hold the word. Caches whose block text changed
+    // since are already dirty and will be rechecked against the new dictionary.
+    const QSet<QTextBlockUserData *> entries = m_spellWordIndex.take(normalized);
+    for (QTextBlockUserData *entry : entries) {
+        auto *data = static_cast<SpellBlockData *>(entry);
+        const bool current = data->textHash == qHash(data->block.text());
+        const int blockStart = data->block.position();
+        for (int i = data->words.size() - 1; i >= 0; --i) {
+            if (data->words.at(i) != normalized) {
+                continue;
+            }
+            if (current) {
+                const Range range = {blockStart + data->misspellings.at(i).start, data->misspellings.at(i).length};
+                const auto it = std::lower_bound(m_spellingRanges.begin(), m_spellingRanges.end(), range.start,
+                                                 [](const Range &r, int start) { return r.start < start; });
+                if (it != m_spellingRanges.end() && it->start == range.start && it->length == range.length) {
+                    m_spellingRanges.erase(it);
+                }
+            }
+            data->misspellings.remove(i);
+            data->words.removeAt(i);
+        }
+    }
+
+    if (m_spellDirtyEnd >= 0) {
+        scheduleSpellcheckRefresh();
+    }
+    refreshHighlights();
+}
+
+void ScriptEditor::setSpellChecker(std::unique_ptr<AbstractSpellChecker> checker)
+{
+    // A background pass reads the checker being replaced
+    cancelSpellcheckPass();
+    m_spellPool.waitForDone();
+    m_spellChecker = std::move(checker);
+
+    for (QTextBlock block = document()->begin(); block.isValid(); block = block.next()) {
+        block.setUserData(nullptr);
+    }
+    m_spellingRanges.clear();
+    refreshHighlights();
+    markSpellcheckDirty(0, document()->characterCount());
+    scheduleSpellcheckRefresh();
+}
+
 ScriptEditor::UndoGroupType ScriptEditor::classifyChar(QChar ch) const
 {
     if (ch.isSpace()) {
@@ -817,46 +1314,54 @@ void ScriptEditor::applyFormatDirect(ElementType type)
 
 void ScriptEditor::buildFormats(ElementType type, QTextBlockFormat &bf, QTextCharFormat &cf) const
 {
-    bf = QTextBlockFormat();
-    cf = QTextCharFormat();
+    const ElementFormats &formats = elementFormats(type);
+    bf = formats.block;
+    cf = formats.chars;
+}
+
+const ScriptEditor::ElementFormats &ScriptEditor::elementFormats(ElementType type) const
+{
+    if (!m_formatCacheValid) {
+        for (int i = 0; i < ElementCount; ++i) {
+            m_formatCache[i] = computeFormats(static_cast<ElementType>(i));
+        }
+        m_formatCacheValid = true;
+    }
+    return m_formatCache[type];
+}
+
+ScriptEditor::ElementFormats ScriptEditor::computeFormats(ElementType type) const
+{
+    ElementFormats formats;
+    QTextBlockFormat &bf = formats.block;
+    QTextCharFormat &cf = formats.chars;
 
     bf.setLineHeight(100, QTextBlockFormat::ProportionalHeight);
 
-    double leftIn = 0.0;
-    double rightIn = 0.0;
-    double widthIn = 6.0;
-    int spaceBeforePx = 0;
+    // Column placement and spacing are shared with the line-grid paginator
+    const LineGridPaginator::ElementGeometry geometry = LineGridPaginator::elementGeometry(type);
+    const double leftIn = geometry.leftInches;
+    const double widthIn = geometry.widthInches;
+    const int spaceBeforePx = geometry.spaceBeforeLines * fontMetrics().height();
 
     QFont::Capitalization caps = QFont::MixedCase;
     Qt::Alignment align = Qt::AlignLeft;
 
     switch (type) {
     case SceneHeading:
-        leftIn = 0.0; widthIn = 6.0; caps = QFont::AllUppercase; spaceBeforePx = static_cast<int>(fontMetrics().height());
-        break;
-    case Action:
-        leftIn = 0.0; widthIn = 6.0; caps = QFont::MixedCase; spaceBeforePx = static_cast<int>(fontMetrics().height());
-        break;
     case CharacterName:
-        leftIn = 2.3; widthIn = 6.0 - 2.3; caps = QFont::AllUppercase; spaceBeforePx = static_cast<int>(fontMetrics().height());
-        break;
-    case Dialogue:
-        leftIn = 1.0; widthIn = 3.5; caps = QFont::MixedCase; spaceBeforePx = 0;
-        break;
-    case Parenthetical:
-        leftIn = 1.5; widthIn = 2.5; caps = QFont::MixedCase; spaceBeforePx = 0;
-        break;
     case Shot:
-        leftIn = 0.0; widthIn = 6.0; caps = QFont::AllUppercase; spaceBeforePx = static_cast<int>(fontMetrics().height());
+        caps = QFont::AllUppercase;
         break;
     case Transition:
-        leftIn = 0.0; widthIn = 6.0; caps = QFont::AllUppercase; spaceBeforePx = static_cast<int>(fontMetrics().height()); align = Qt::AlignRight;
+        caps = QFont::AllUppercase;
+        align = Qt::AlignRight;
         break;
     default:
         break;
     }
 
-    rightIn = 6.0 - leftIn - widthIn;
+    double rightIn = 6.0 - leftIn - widthIn;
     if (rightIn < 0.0) rightIn = 0.0;
 
     bf.setLeftMargin(inchToPx(leftIn));
@@ -865,54 +1370,115 @@ void ScriptEditor::buildFormats(ElementType type, QTextBlockFormat &bf, QTextCha
     bf.setAlignment(align);
 
     cf.setFontCapitalization(caps);
+    return formats;
 }
 
-QTextDocument::FindFlags ScriptEditor::currentFindFlags() const
+void ScriptEditor::rebuildFindMatches()
 {
-    QTextDocument::FindFlags flags;
-    if (m_findCaseSensitive) {
-        flags |= QTextDocument::FindCaseSensitively;
+    LatencyTrace::Scope trace(LatencyTrace::FindMatches);
+    m_findMatches.clear();
+    m_activeFindIndex = -1;
+
+    const QString needle = m_findQuery.trimmed();
+    if (needle.isEmpty()) {
+        refreshHighlights();
+        emit findResultsChanged(-1, 0);
+        return;
+    }
+
+    for (QTextBlock block = document()->begin(); block.isValid(); block = block.next()) {
+        appendBlockMatches(block, needle, m_findMatches);
     }
-    if (m_findWholeWord) {
-        flags |= QTextDocument::FindWholeWords;
+
+    if (!m_findMatches.isEmpty()) {
+        applyFindMatchAtIndex(0);
+    } else {
+        refreshHighlights();
+        emit findResultsChanged(-1, 0);
     }
-    return flags;
 }
 
-void ScriptEditor::rebuildFindMatches()
+void ScriptEditor::updateHighlightRanges(int position, int charsRemoved, int charsAdded)
 {
-    m_findMatches.clear();
-    m_activeFindIndex = -1;
+    // Highlights never span blocks, so only the blocks the edit now covers can gain or lose
+    // one. In old offsets those blocks ran up to the same end, less the edit's growth.
+    QTextDocument *doc = document();
+    const int delta = charsAdded - charsRemoved;
+    const QTextBlock firstBlock = doc->findBlock(position);
+    QTextBlock lastBlock = doc->findBlock(position + charsAdded);
+    if (!lastBlock.isValid()) {
+        lastBlock = doc->lastBlock();
+    }
+    const int regionStart = firstBlock.isValid() ? firstBlock.position() : 0;
+    const int regionEnd = lastBlock.position() + lastBlock.length();
+    const int oldRegionEnd = regionEnd - delta;
+
+    // Misspellings in the edited blocks wait for the scheduled recheck of just those blocks
+    HighlightLayer::removeEditedRanges(m_spellingRanges, regionStart, oldRegionEnd, delta);
+    cancelSpellcheckPass();
+    if (m_spellDirtyEnd >= 0) {
+        auto shifted = [&](int pos) { return pos >= oldRegionEnd ? pos + delta : qMin(pos, regionStart); };
+        m_spellDirtyStart = shifted(m_spellDirtyStart);
+        m_spellDirtyEnd = shifted(m_spellDirtyEnd);
+    }
+    markSpellcheckDirty(regionStart, regionEnd);
 
     const QString needle = m_findQuery.trimmed();
     if (needle.isEmpty()) {
-        refreshExtraSelections();
-        emit findResultsChanged(-1, 0);
+        refreshHighlights();
         return;
     }
+    LatencyTrace::Scope trace(LatencyTrace::FindMatches);
 
-    QTextCursor cursor(document());
-    const QTextDocument::FindFlags flags = currentFindFlags();
+    const int activeStart = m_activeFindIndex >= 0 ? m_findMatches[m_activeFindIndex].start : -1;
+    const int insertIndex = HighlightLayer::removeEditedRanges(m_findMatches, regionStart, oldRegionEnd, delta);
 
-    while (true) {
-        cursor = document()->find(needle, cursor, flags);
-        if (cursor.isNull()) {
+    QVector<Range> rescanned;
+    for (QTextBlock block = firstBlock; block.isValid(); block = block.next()) {
+        appendBlockMatches(block, needle, rescanned);
+        if (block == lastBlock) {
             break;
         }
+    }
+    m_findMatches.insert(insertIndex, rescanned.size(), Range());
+    std::copy(rescanned.cbegin(), rescanned.cend(), m_findMatches.begin() + insertIndex);
 
-        Range range;
-        range.start = cursor.selectionStart();
-        range.length = cursor.selectionEnd() - cursor.selectionStart();
-        if (range.length > 0) {
-            m_findMatches.append(range);
-        }
+    // Keep the active match when it survived the edit; the cursor stays where the user typed
+    m_activeFindIndex = -1;
+    if (activeStart >= 0 && !m_findMatches.isEmpty()) {
+        const int shiftedStart = activeStart >= oldRegionEnd ? activeStart + delta : activeStart;
+        const auto active = std::lower_bound(m_findMatches.cbegin(), m_findMatches.cend(), shiftedStart,
+                                             [](const Range &range, int pos) { return range.start < pos; });
+        m_activeFindIndex = active != m_findMatches.cend() && active->start == shiftedStart
+            ? static_cast<int>(active - m_findMatches.cbegin())
+            : qMin(static_cast<int>(active - m_findMatches.cbegin()), static_cast<int>(m_findMatches.size()) - 1);
     }
 
-    if (!m_findMatches.isEmpty()) {
-        applyFindMatchAtIndex(0);
-    } else {
-        refreshExtraSelections();
-        emit findResultsChanged(-1, 0);
+    refreshHighlights();
+    emit findResultsChanged(m_activeFindIndex, m_findMatches.size());
+}
+
+void ScriptEditor::appendBlockMatches(const QTextBlock &block, const QString &needle, QVector<Range> &matches) const
+{
+    // Same rules as QTextDocument::find: non-overlapping, whole words bounded by non-alphanumerics
+    QString text = block.text();
+    text.replace(QChar::Nbsp, QLatin1Char(' '));
+    const Qt::CaseSensitivity sensitivity = m_findCaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    const int needleLength = needle.size();
+
+    int from = 0;
+    while (true) {
+        const int index = text.indexOf(needle, from, sensitivity);
+        if (index < 0) {
+            break;
+        }
+        const int end = index + needleLength;
+        if (m_findWholeWord && !TextTokenizer::isWholeWord(text, index, needleLength)) {
+            from = index + 1;
+            continue;
+        }
+        matches.append(Range{block.position() + index, needleLength});
+        from = end;
     }
 }
 
@@ -920,7 +1486,7 @@ void ScriptEditor::applyFindMatchAtIndex(int index)
 {
     if (m_findMatches.isEmpty()) {
         m_activeFindIndex = -1;
-        refreshExtraSelections();
+        refreshHighlights();
         emit findResultsChanged(-1, 0);
         return;
     }
@@ -934,32 +1500,148 @@ void ScriptEditor::applyFindMatchAtIndex(int index)
     setTextCursor(cursor);
     ensureCursorVisible();
 
-    refreshExtraSelections();
+    refreshHighlights();
     emit findResultsChanged(m_activeFindIndex, m_findMatches.size());
 }
 
 void ScriptEditor::refreshSpellcheck()
 {
+    LatencyTrace::Scope trace(LatencyTrace::Spellcheck);
+    cancelSpellcheckPass();
     if (!m_spellcheckEnabled || !m_spellChecker || !m_spellChecker->isAvailable()) {
         m_spellingRanges.clear();
-        refreshExtraSelections();
+        refreshHighlights();
+        return;
+    }
+    if (m_spellDirtyEnd < 0) {
         return;
     }
 
-    m_spellingRanges.clear();
-    const QList<Misspelling> misspellings = m_spellChecker->checkText(toPlainText());
-    m_spellingRanges.reserve(misspellings.size());
-    for (const Misspelling &item : misspellings) {
-        if (item.length <= 0) {
-            continue;
+    // Only the blocks edited since the last pass are visited, and of those only the ones
+    // whose text changed are checked again
+    QTextDocument *doc = document();
+    QTextBlock firstBlock = doc->findBlock(m_spellDirtyStart);
+    if (!firstBlock.isValid()) {
+        firstBlock = doc->lastBlock();
+    }
+    QTextBlock lastBlock = doc->findBlock(qMax(m_spellDirtyStart, m_spellDirtyEnd - 1));
+    if (!lastBlock.isValid()) {
+        lastBlock = doc->lastBlock();
+    }
+    m_spellDirtyStart = -1;
+    m_spellDirtyEnd = -1;
+
+    QVector<SpellBlock> blocks;
+    bool needsCheck = false;
+    for (QTextBlock block = firstBlock; block.isValid(); block = block.next()) {
+        SpellBlock item;
+        item.position = block.position();
+        item.text = block.text();
+        item.textHash = qHash(item.text);
+        if (const SpellBlockData *data = cachedMisspellings(block, item.textHash)) {
+            item.cached = true;
+            item.misspellings = data->misspellings;
+        } else {
+            needsCheck = true;
+        }
+        blocks.append(item);
+        if (block == lastBlock) {
+            break;
+        }
+    }
+
+    const int generation = ++m_spellGeneration;
+    if (!needsCheck || !m_spellChecker->supportsBackgroundChecks()) {
+        for (SpellBlock &item : blocks) {
+            if (!item.cached) {
+                item.misspellings = checkBlockText(*m_spellChecker, item.text);
+            }
         }
-        Range range;
-        range.start = item.start;
-        range.length = item.length;
-        m_spellingRanges.append(range);
+        applySpellcheckChunk(generation, blocks, true);
+        return;
     }
 
-    refreshExtraSelections();
+    // Check the snapshot on the pool and hand results back a chunk of blocks at a time. Any
+    // edit or dictionary change bumps the generation, which stops the job between blocks.
+    m_spellPendingStart = firstBlock.position();
+    m_spellPendingEnd = lastBlock.position() + lastBlock.length();
+    const AbstractSpellChecker *checker = m_spellChecker.get();
+    m_spellPool.start([this, checker, generation, blocks]() mutable {
+        constexpr int kChunkBlocks = 64;
+        for (int begin = 0; begin < blocks.size(); begin += kChunkBlocks) {
+            const int end = qMin(begin + kChunkBlocks, static_cast<int>(blocks.size()));
+            for (int i = begin; i < end; ++i) {
+                if (m_spellGeneration.load() != generation) {
+                    return;
+                }
+                if (!blocks[i].cached) {
+                    blocks[i].misspellings = checkBlockText(*checker, blocks[i].text);
+                }
+            }
+            const QVector<SpellBlock> chunk = blocks.mid(begin, end - begin);
+            const bool last = end == blocks.size();
+            QMetaObject::invokeMethod(this, [this, generation, chunk, last] {
+                applySpellcheckChunk(generation, chunk, last);
+            }, Qt::QueuedConnection);
+        }
+    });
+}
+
+void ScriptEditor::applySpellcheckChunk(int generation, const QVector<SpellBlock> &chunk, bool last)
+{
+    // Results from a superseded pass describe text that has since changed
+    if (generation != m_spellGeneration.load() || chunk.isEmpty()) {
+        return;
+    }
+    LatencyTrace::Scope trace(LatencyTrace::Spellcheck);
+
+    QTextDocument *doc = document();
+    QVector<Range> found;
+    for (const SpellBlock &item : chunk) {
+        if (!item.cached) {
+            cacheMisspellings(doc->findBlock(item.position), item.text, item.textHash, item.misspellings, m_spellWordIndex);
+        }
+        for (const Range &range : item.misspellings) {
+            found.append({item.position + range.start, range.length});
+        }
+    }
+
+    // Chunks cover whole consecutive blocks, each one character longer than its text
+    const int spanStart = chunk.first().position;
+    const int spanEnd = chunk.last().position + chunk.last().text.size() + 1;
+    const int insertIndex = HighlightLayer::removeEditedRanges(m_spellingRanges, spanStart, spanEnd, 0);
+    m_spellingRanges.insert(insertIndex, found.size(), Range());
+    std::copy(found.cbegin(), found.cend(), m_spellingRanges.begin() + insertIndex);
+
+    if (last) {
+        m_spellPendingStart = -1;
+        m_spellPendingEnd = -1;
+    } else {
+        m_spellPendingStart = spanEnd;
+    }
+    refreshHighlights();
+}
+
+void ScriptEditor::cancelSpellcheckPass()
+{
+    ++m_spellGeneration;
+    if (m_spellPendingEnd >= 0) {
+        // Whatever the pass had not delivered yet is checked again next time
+        markSpellcheckDirty(m_spellPendingStart, m_spellPendingEnd);
+        m_spellPendingStart = -1;
+        m_spellPendingEnd = -1;
+    }
+}
+
+void ScriptEditor::markSpellcheckDirty(int start, int end)
+{
+    if (m_spellDirtyEnd < 0) {
+        m_spellDirtyStart = start;
+        m_spellDirtyEnd = end;
+        return;
+    }
+    m_spellDirtyStart = qMin(m_spellDirtyStart, start);
+    m_spellDirtyEnd = qMax(m_spellDirtyEnd, end);
 }
 
 void ScriptEditor::scheduleSpellcheckRefresh()
@@ -994,7 +1676,7 @@ bool ScriptEditor::replaceCurrent(const QString &replacement)
     auto *cmd = new CompoundCommand("replace");
     new DeleteTextCommand(this, range.start, normalizeSelectedText(cursor.selectedText()), UndoGroupType::Bulk, false, false, cmd);
     new InsertTextCommand(this, range.start, replacement, UndoGroupType::Bulk, false, cmd);
-    m_undoStack.push(cmd);
+    pushCommand(cmd);
 
     findNext();
     return true;
@@ -1006,21 +1688,13 @@ int ScriptEditor::replaceAll(const QString &replacement)
         return 0;
     }
 
-    const int count = m_findMatches.size();
-    auto *cmd = new CompoundCommand("replace all");
-
-    // Iterate in reverse order so that position changes don't affect lower positions
-    for (int i = count - 1; i >= 0; --i) {
-        const Range &range = m_findMatches[i];
-        QTextCursor cursor(document());
-        cursor.setPosition(range.start);
-        cursor.setPosition(range.start + range.length, QTextCursor::KeepAnchor);
-        new DeleteTextCommand(this, range.start, normalizeSelectedText(cursor.selectedText()), UndoGroupType::Bulk, false, false, cmd);
-        new InsertTextCommand(this, range.start, replacement, UndoGroupType::Bulk, false, cmd);
+    QVector<ReplaceAllCommand::Span> spans;
+    spans.reserve(m_findMatches.size());
+    for (const Range &range : std::as_const(m_findMatches)) {
+        spans.append({range.start, range.length});
     }
-
-    m_undoStack.push(cmd);
-    return count;
+    pushCommand(new ReplaceAllCommand(this, spans, replacement));
+    return spans.size();
 }
 
 void ScriptEditor::replaceRangeText(int start, int length, const QString &replacement)
@@ -1033,49 +1707,16 @@ void ScriptEditor::replaceRangeText(int start, int length, const QString &replac
     QUndoCommand *cmdParent = new CompoundCommand("replace");
     new DeleteTextCommand(this, start, normalizeSelectedText(cursor.selectedText()), UndoGroupType::Bulk, false, false, cmdParent);
     new InsertTextCommand(this, start, replacement, UndoGroupType::Bulk, false, cmdParent);
-    m_undoStack.push(cmdParent);
+    pushCommand(cmdParent);
 
     scheduleSpellcheckRefresh();
 }
 
-void ScriptEditor::refreshExtraSelections()
+void ScriptEditor::refreshHighlights()
 {
-    QList<QTextEdit::ExtraSelection> selections;
-
-    QTextCharFormat misspelledFormat;
-    misspelledFormat.setUnderlineColor(QColor("#E06C75"));
-    misspelledFormat.setUnderlineStyle(QTextCharFormat::SpellCheckUnderline);
-
-    for (const Range &range : m_spellingRanges) {
-        QTextEdit::ExtraSelection sel;
-        QTextCursor cursor(document());
-        cursor.setPosition(range.start);
-        cursor.setPosition(range.start + range.length, QTextCursor::KeepAnchor);
-        sel.cursor = cursor;
-        sel.format = misspelledFormat;
-        selections.append(sel);
-    }
-
-    QTextCharFormat matchFormat;
-    matchFormat.setBackground(QColor("#7B93C466"));
-    matchFormat.setForeground(QColor("#101319"));
-
-    QTextCharFormat activeMatchFormat;
-    activeMatchFormat.setBackground(QColor("#98B7F0"));
-    activeMatchFormat.setForeground(QColor("#101319"));
-
-    for (int i = 0; i < m_findMatches.size(); ++i) {
-        const Range &range = m_findMatches[i];
-        QTextEdit::ExtraSelection sel;
-        QTextCursor cursor(document());
-        cursor.setPosition(range.start);
-        cursor.setPosition(range.start + range.length, QTextCursor::KeepAnchor);
-        sel.cursor = cursor;
-        sel.format = (i == m_activeFindIndex) ? activeMatchFormat : matchFormat;
-        selections.append(sel);
-    }
-
-    setExtraSelections(selections);
+    // The layer owns the range lists; painting picks out the visible ones
+    m_highlights.setActiveIndex(HighlightLayer::FindMatch, m_activeFindIndex);
+    viewport()->update();
 }
 
 
@@ -1,4 +1,5 @@
 #include "scripteditor_undo.h"
+#include "latencytrace.h"
 #include "scripteditor.h"
 #include <QTextCursor>
 #include <QTextBlock>
@@ -14,10 +15,22 @@ QString normalizeSelectedText(const QString &text)
 
 CompoundCommand::CompoundCommand(const QString &text) : QUndoCommand(text) {}
 
+void CompoundCommand::redo()
+{
+    LatencyTrace::Scope trace(LatencyTrace::UndoCommand);
+    QUndoCommand::redo();
+}
+
+void CompoundCommand::undo()
+{
+    LatencyTrace::Scope trace(LatencyTrace::UndoCommand);
+    QUndoCommand::undo();
+}
+
 InsertTextCommand::InsertTextCommand(ScriptEditor *editor, int pos, const QString &text,
                                      ScriptEditor::UndoGroupType type, bool allowMerge,
                                      QUndoCommand *parent)
-    : QUndoCommand(parent), m_editor(editor), m_pos(pos), m_text(text),
+    : SizedUndoCommand(parent), m_editor(editor), m_pos(pos), m_text(text),
       m_type(type), m_allowMerge(allowMerge) {}
 
 int InsertTextCommand::id() const { return 1; }
@@ -60,27 +73,34 @@ bool InsertTextCommand::mergeWith(const QUndoCommand *other)
 
 void InsertTextCommand::redo()
 {
+    LatencyTrace::Scope trace(LatencyTrace::UndoCommand);
     QTextCursor c(m_editor->document());
     c.setPosition(m_pos);
     c.insertText(m_text);
     c.setPosition(m_pos + m_text.length());
-    m_editor->setTextCursor(c);
+    m_editor->placeCursor(c);
 }
 
 void InsertTextCommand::undo()
 {
+    LatencyTrace::Scope trace(LatencyTrace::UndoCommand);
     QTextCursor c(m_editor->document());
     c.setPosition(m_pos);
     c.setPosition(m_pos + m_text.length(), QTextCursor::KeepAnchor);
     c.removeSelectedText();
     c.setPosition(m_pos);
-    m_editor->setTextCursor(c);
+    m_editor->placeCursor(c);
+}
+
+qsizetype InsertTextCommand::memoryCost() const
+{
+    return sizeof(*this) + m_text.size() * sizeof(QChar);
 }
 
 DeleteTextCommand::DeleteTextCommand(ScriptEditor *editor, int pos, const QString &text,
                                      ScriptEditor::UndoGroupType type, bool allowMerge,
                                      bool backspace, QUndoCommand *parent)
-    : QUndoCommand(parent), m_editor(editor), m_pos(pos), m_text(text),
+    : SizedUndoCommand(parent), m_editor(editor), m_pos(pos), m_text(text),
       m_type(type), m_allowMerge(allowMerge), m_backspace(backspace) {}
 
 int DeleteTextCommand::id() const { return 2; }
@@ -110,30 +130,106 @@ bool DeleteTextCommand::mergeWith(const QUndoCommand *other)
 
 void DeleteTextCommand::redo()
 {
+    LatencyTrace::Scope trace(LatencyTrace::UndoCommand);
     QTextCursor c(m_editor->document());
     c.setPosition(m_pos);
     c.setPosition(m_pos + m_text.length(), QTextCursor::KeepAnchor);
     c.removeSelectedText();
     c.setPosition(m_pos);
-    m_editor->setTextCursor(c);
+    m_editor->placeCursor(c);
 }
 
 void DeleteTextCommand::undo()
 {
+    LatencyTrace::Scope trace(LatencyTrace::UndoCommand);
     QTextCursor c(m_editor->document());
     c.setPosition(m_pos);
     c.insertText(m_text);
     c.setPosition(m_pos + m_text.length());
-    m_editor->setTextCursor(c);
+    m_editor->placeCursor(c);
+}
+
+qsizetype DeleteTextCommand::memoryCost() const
+{
+    return sizeof(*this) + m_text.size() * sizeof(QChar);
+}
+
+ReplaceAllCommand::ReplaceAllCommand(ScriptEditor *editor, const QVector<Span> &spans, const QString &replacement,
+                                     QUndoCommand *parent)
+    : SizedUndoCommand(QStringLiteral("replace all"), parent), m_editor(editor), m_spans(spans), m_replacement(replacement)
+{
+    QTextCursor c(editor->document());
+    for (const Span &span : m_spans) {
+        c.setPosition(span.start);
+        c.setPosition(span.start + span.length, QTextCursor::KeepAnchor);
+        m_originals += normalizeSelectedText(c.selectedText());
+    }
+}
+
+void ReplaceAllCommand::redo()
+{
+    LatencyTrace::Scope trace(LatencyTrace::UndoCommand);
+    if (m_spans.isEmpty()) {
+        return;
+    }
+    QTextCursor c(m_editor->document());
+    c.beginEditBlock();
+    // Last match first, so earlier offsets still hold
+    for (int i = m_spans.size() - 1; i >= 0; --i) {
+        c.setPosition(m_spans[i].start);
+        c.setPosition(m_spans[i].start + m_spans[i].length, QTextCursor::KeepAnchor);
+        c.insertText(m_replacement);
+    }
+    c.endEditBlock();
+    c.setPosition(m_spans.first().start + m_replacement.length());
+    m_editor->placeCursor(c);
+}
+
+void ReplaceAllCommand::undo()
+{
+    LatencyTrace::Scope trace(LatencyTrace::UndoCommand);
+    if (m_spans.isEmpty()) {
+        return;
+    }
+    // Where each replacement sits now: every earlier match changed length by the difference
+    QVector<int> replacedStarts(m_spans.size());
+    QVector<int> originalOffsets(m_spans.size());
+    int shift = 0;
+    int offset = 0;
+    for (int i = 0; i < m_spans.size(); ++i) {
+        replacedStarts[i] = m_spans[i].start + shift;
+        originalOffsets[i] = offset;
+        shift += m_replacement.length() - m_spans[i].length;
+        offset += m_spans[i].length;
+    }
+
+    QTextCursor c(m_editor->document());
+    c.beginEditBlock();
+    for (int i = m_spans.size() - 1; i >= 0; --i) {
+        c.setPosition(replacedStarts[i]);
+        c.setPosition(replacedStarts[i] + m_replacement.length(), QTextCursor::KeepAnchor);
+        c.insertText(m_originals.mid(originalOffsets[i], m_spans[i].length));
+    }
+    c.endEditBlock();
+    c.setPosition(m_spans.first().start + m_spans.first().length);
+    m_editor->placeCursor(c);
+}
+
+qsizetype ReplaceAllCommand::memoryCost() const
+{
+    return sizeof(*this) + m_spans.size() * sizeof(Span) + (m_originals.size() + m_replacement.size()) * sizeof(QChar);
 }
 
 FormatCommand::FormatCommand(ScriptEditor *editor, int blockPos, const QTextBlockFormat &newBlock,
                              const QTextCharFormat &newChar, int newState, QUndoCommand *parent)
-    : QUndoCommand(parent), m_editor(editor), m_blockPos(blockPos), m_newBlock(newBlock),
-      m_newChar(newChar), m_newState(newState) {}
+    : SizedUndoCommand(parent), m_editor(editor), m_blockPos(blockPos), m_newBlock(newBlock),
+      m_newChar(newChar), m_newState(newState)
+{
+}
 
 void FormatCommand::redo()
 {
+    LatencyTrace::Scope trace(LatencyTrace::UndoCommand);
     if (!m_captured) {
         QTextCursor c(m_editor->document());
         c.setPosition(m_blockPos);
@@ -149,9 +245,15 @@ void FormatCommand::redo()
 
 void FormatCommand::undo()
 {
+    LatencyTrace::Scope trace(LatencyTrace::UndoCommand);
     applyWithText(m_oldBlock, m_oldChar, m_oldState, m_oldText);
 }
 
+qsizetype FormatCommand::memoryCost() const
+{
+    return sizeof(*this) + m_oldText.size() * sizeof(QChar);
+}
+
 void FormatCommand::apply(const QTextBlockFormat &bf, const QTextCharFormat &cf, int state)
 {
     QTextCursor c(m_editor->document());
@@ -160,7 +262,8 @@ void FormatCommand::apply(const QTextBlockFormat &bf, const QTextCharFormat &cf,
     c.setBlockCharFormat(cf);
     QTextBlock block = c.block();
     block.setUserState(state);
-    if (m_editor->textCursor().block().position() == m_blockPos) {
+    // Inside a transaction the editor announces the element once it commits
+    if (!m_editor->inEditTransaction() && m_editor->textCursor().block().position() == m_blockPos) {
         emit m_editor->elementChanged(static_cast<ScriptEditor::ElementType>(state));
     }
 }
@@ -182,7 +285,7 @@ void FormatCommand::applyWithText(const QTextBlockFormat &bf, const QTextCharFor
     block = c.block();
     block.setUserState(state);
     
-    if (m_editor->textCursor().block().position() == m_blockPos) {
+    if (!m_editor->inEditTransaction() && m_editor->textCursor().block().position() == m_blockPos) {
         emit m_editor->elementChanged(static_cast<ScriptEditor::ElementType>(state));
     }
 }
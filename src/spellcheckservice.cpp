@@ -1,7 +1,12 @@
 #include "spellcheckservice.h"
 
-#include <QRegularExpression>
+#include "basedictionary.h"
+#include "editdistance.h"
+#include "texttokenizer.h"
+
+#include <QVarLengthArray>
 #include <QVector>
+#include <algorithm>
 
 namespace {
 QString normalizeWord(const QString &word)
@@ -9,54 +14,66 @@ QString normalizeWord(const QString &word)
     return word.trimmed().toLower();
 }
 
-const QSet<QString> &baseDictionary()
+// Built on first use and only read afterwards, so checkers on any thread can share it
+const SuggestionIndex &baseSuggestionIndex()
 {
-    static const QSet<QString> words = {
-        "a", "about", "above", "after", "again", "all", "also", "am", "an", "and", "any", "are", "as", "at",
-        "back", "be", "because", "been", "before", "being", "between", "but", "by", "can", "come", "could",
-        "day", "did", "do", "does", "down", "each", "even", "every", "for", "from", "get", "go", "good",
-        "had", "has", "have", "he", "her", "here", "him", "his", "how", "i", "if", "in", "into", "is", "it",
-        "its", "just", "know", "like", "look", "make", "man", "me", "more", "my", "new", "no", "not", "now",
-        "of", "on", "one", "only", "or", "other", "our", "out", "over", "people", "right", "said", "same",
-        "say", "scene", "screenplay", "script", "see", "she", "so", "some", "story", "take", "than", "that",
-        "the", "their", "them", "then", "there", "these", "they", "this", "time", "to", "two", "up", "use",
-        "very", "want", "was", "way", "we", "well", "were", "what", "when", "where", "which", "who", "will",
-        "with", "work", "would", "write", "writer", "you", "your",
-        "int", "ext", "est", "fade", "cut", "dissolve", "to", "continuously", "later", "night", "day", "interior", "exterior"
-    };
-    return words;
+    static const SuggestionIndex index = [] {
+        SuggestionIndex built;
+        built.build(BaseDictionary::words());
+        return built;
+    }();
+    return index;
 }
 }
 
-BasicSpellChecker::BasicSpellChecker()
-    : m_dictionary(baseDictionary())
-{
-}
-
-QList<Misspelling> BasicSpellChecker::checkText(const QString &text) const
+QList<Misspelling> findUnknownWords(QStringView text, const std::function<bool(QStringView)> &isKnown)
 {
     QList<Misspelling> result;
-    static const QRegularExpression tokenRegex("[A-Za-z][A-Za-z']*");
+    QVarLengthArray<char16_t, 64> lower;
 
-    QRegularExpressionMatchIterator it = tokenRegex.globalMatch(text);
-    while (it.hasNext()) {
-        const QRegularExpressionMatch match = it.next();
-        const QString word = match.captured(0);
-        if (isLikelyCorrectToken(word)) {
+    TextTokenizer::SpellingWords words(text);
+    TextTokenizer::Token token;
+    while (words.next(token)) {
+        if (token.length <= 2) {
+            continue;
+        }
+        const QStringView word = text.mid(token.start, token.length);
+        // All caps reads as a name or a slug line
+        if (std::none_of(word.cbegin(), word.cend(), [](QChar ch) { return ch.isLower(); })) {
+            continue;
+        }
+        // Tokens are ASCII letters and apostrophes, so folding case is one bit per unit
+        lower.resize(token.length);
+        for (int i = 0; i < token.length; ++i) {
+            const char16_t ch = word[i].unicode();
+            lower[i] = (ch >= u'A' && ch <= u'Z') ? char16_t(ch | 0x20) : ch;
+        }
+        if (isKnown(QStringView(lower.constData(), lower.size()))) {
             continue;
         }
 
         Misspelling item;
-        item.start = match.capturedStart(0);
-        item.length = match.capturedLength(0);
-        item.word = word;
-        item.suggestions = suggestionsFor(word);
+        item.start = token.start;
+        item.length = token.length;
+        item.word = word.toString();
         result.append(item);
     }
 
     return result;
 }
 
+BasicSpellChecker::BasicSpellChecker(const QString &userDictionaryPath)
+    : m_userDictionary(userDictionaryPath)
+{
+    baseSuggestionIndex();
+    m_userSuggestionIndex.build(m_userDictionary.words());
+}
+
+QList<Misspelling> BasicSpellChecker::checkText(const QString &text) const
+{
+    return findUnknownWords(text, [this](QStringView word) { return isKnownWord(word); });
+}
+
 QStringList BasicSpellChecker::suggestionsFor(const QString &word) const
 {
     const QString normalized = normalizeWord(word);
@@ -64,96 +81,50 @@ QStringList BasicSpellChecker::suggestionsFor(const QString &word) const
         return {};
     }
 
-    struct Candidate {
-        QString word;
-        int distance = 0;
-    };
-
-    QVector<Candidate> candidates;
-    candidates.reserve(16);
-
-    for (const QString &entry : m_dictionary) {
-        if (qAbs(entry.size() - normalized.size()) > 2) {
-            continue;
-        }
-        if (entry.front() != normalized.front()) {
-            continue;
-        }
-
-        const int distance = editDistance(entry, normalized);
-        if (distance <= 2) {
-            candidates.push_back({entry, distance});
-        }
+    QMutexLocker locker(&m_suggestionMutex);
+    if (const QStringList *cached = m_suggestionCache.object(normalized)) {
+        return *cached;
     }
-
-    std::sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) {
-        if (a.distance == b.distance) {
-            return a.word < b.word;
-        }
-        return a.distance < b.distance;
-    });
-
-    QStringList result;
-    for (const Candidate &candidate : candidates) {
-        result.append(candidate.word);
-        if (result.size() >= 6) {
-            break;
+    QStringList suggestions = baseSuggestionIndex().suggestions(normalized, 6);
+    const QStringList userSuggestions = m_userSuggestionIndex.suggestions(normalized, 6);
+    if (!userSuggestions.isEmpty()) {
+        // Both lists are ranked the same way, so one re-rank of their union keeps the order
+        for (const QString &candidate : userSuggestions) {
+            if (!suggestions.contains(candidate)) {
+                suggestions.append(candidate);
+            }
         }
+        std::stable_sort(suggestions.begin(), suggestions.end(), [&normalized](const QString &a, const QString &b) {
+            const int da = EditDistance::bounded(normalized, a, SuggestionIndex::kMaxDistance);
+            const int db = EditDistance::bounded(normalized, b, SuggestionIndex::kMaxDistance);
+            return da != db ? da < db : a < b;
+        });
+        suggestions = suggestions.mid(0, 6);
     }
-
-    return result;
+    m_suggestionCache.insert(normalized, new QStringList(suggestions));
+    return suggestions;
 }
 
 void BasicSpellChecker::addWord(const QString &word)
 {
-    const QString normalized = normalizeWord(word);
-    if (!normalized.isEmpty()) {
-        m_userDictionary.insert(normalized);
-    }
-}
-
-bool BasicSpellChecker::isLikelyCorrectToken(const QString &word) const
-{
-    if (word.size() <= 2) {
-        return true;
-    }
-
-    if (word == word.toUpper()) {
-        return true;
-    }
-
     const QString normalized = normalizeWord(word);
     if (normalized.isEmpty()) {
-        return true;
+        return;
+    }
+    if (!m_userDictionary.add(normalized)) {
+        return;
     }
 
-    return m_dictionary.contains(normalized) || m_userDictionary.contains(normalized);
+    // The new word can now be suggested, so cached lists are out of date
+    QMutexLocker locker(&m_suggestionMutex);
+    m_userSuggestionIndex.addWord(normalized);
+    m_suggestionCache.clear();
 }
 
-int BasicSpellChecker::editDistance(const QString &a, const QString &b) const
+bool BasicSpellChecker::isKnownWord(QStringView word) const
 {
-    const int n = a.size();
-    const int m = b.size();
-
-    QVector<int> prev(m + 1);
-    QVector<int> curr(m + 1);
-
-    for (int j = 0; j <= m; ++j) {
-        prev[j] = j;
-    }
-
-    for (int i = 1; i <= n; ++i) {
-        curr[0] = i;
-        for (int j = 1; j <= m; ++j) {
-            const int cost = (a[i - 1] == b[j - 1]) ? 0 : 1;
-            curr[j] = std::min({
-                prev[j] + 1,
-                curr[j - 1] + 1,
-                prev[j - 1] + cost
-            });
-        }
-        prev = curr;
+    if (BaseDictionary::contains(word)) {
+        return true;
     }
-
-    return prev[m];
+    return m_userDictionary.contains(word);
 }
@@ -0,0 +1,132 @@
+#include "suggestionindex.h"
+
+#include "editdistance.h"
+
+#include <algorithm>
+
+namespace {
+
+quint32 foldHash(const QString &text)
+{
+    const quint64 hash = qHash(text);
+    return static_cast<quint32>(hash ^ (hash >> 32));
+}
+
+} // namespace
+
+void SuggestionIndex::build(const QStringList &words)
+{
+    m_words.clear();
+    m_known.clear();
+    m_entries.clear();
+    m_addedEntries.clear();
+
+    for (const QString &word : words) {
+        if (word.isEmpty() || m_known.contains(word)) {
+            continue;
+        }
+        const int id = m_words.size();
+        m_words.append(word);
+        m_known.insert(word);
+        for (quint32 hash : deleteHashes(word)) {
+            m_entries.append({hash, id});
+        }
+    }
+    std::sort(m_entries.begin(), m_entries.end(),
+              [](const Entry &a, const Entry &b) { return a.deleteHash < b.deleteHash; });
+}
+
+void SuggestionIndex::addWord(const QString &word)
+{
+    if (word.isEmpty() || m_known.contains(word)) {
+        return;
+    }
+    const int id = m_words.size();
+    m_words.append(word);
+    m_known.insert(word);
+    for (quint32 hash : deleteHashes(word)) {
+        m_addedEntries.insert(hash, id);
+    }
+}
+
+QStringList SuggestionIndex::suggestions(const QString &word, int maxResults) const
+{
+    struct Candidate {
+        int wordId = 0;
+        int distance = 0;
+    };
+
+    QVector<Candidate> candidates;
+    QSet<int> seen;
+    auto consider = [&](int id) {
+        if (seen.contains(id)) {
+            return;
+        }
+        seen.insert(id);
+        const int distance = EditDistance::bounded(m_words.at(id), word, kMaxDistance);
+        if (distance <= kMaxDistance) {
+            candidates.append({id, distance});
+        }
+    };
+
+    for (quint32 hash : deleteHashes(word)) {
+        const auto indexed = std::equal_range(m_entries.cbegin(), m_entries.cend(), Entry{hash, 0},
+                                              [](const Entry &a, const Entry &b) { return a.deleteHash < b.deleteHash; });
+        for (auto it = indexed.first; it != indexed.second; ++it) {
+            consider(it->wordId);
+        }
+        const auto added = m_addedEntries.equal_range(hash);
+        for (auto it = added.first; it != added.second; ++it) {
+            consider(it.value());
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [this](const Candidate &a, const Candidate &b) {
+        if (a.distance == b.distance) {
+            return m_words.at(a.wordId) < m_words.at(b.wordId);
+        }
+        return a.distance < b.distance;
+    });
+
+    QStringList result;
+    for (const Candidate &candidate : candidates) {
+        if (result.size() >= maxResults) {
+            break;
+        }
+        result.append(m_words.at(candidate.wordId));
+    }
+    return result;
+}
+
+QVector<quint32> SuggestionIndex::deleteHashes(const QString &word)
+{
+    // Breadth-first over deletion depth; single characters are not reduced further so
+    // short words do not all meet at the empty string
+    QSet<QString> seen;
+    QVector<QString> frontier = { word.left(kPrefixLength) };
+    seen.insert(frontier.first());
+    for (int depth = 0; depth < kMaxDistance; ++depth) {
+        QVector<QString> next;
+        for (const QString &text : frontier) {
+            if (text.size() <= 1) {
+                continue;
+            }
+            for (int i = 0; i < text.size(); ++i) {
+                QString reduced = text;
+                reduced.remove(i, 1);
+                if (!seen.contains(reduced)) {
+                    seen.insert(reduced);
+                    next.append(reduced);
+                }
+            }
+        }
+        frontier = next;
+    }
+
+    QVector<quint32> hashes;
+    hashes.reserve(seen.size());
+    for (const QString &text : seen) {
+        hashes.append(foldHash(text));
+    }
+    return hashes;
+}
@@ -0,0 +1,209 @@
+#include "texttokenizer.h"
+
+#include <QtAlgorithms>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SCREENQT_TOKENIZER_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define SCREENQT_TOKENIZER_NEON
+#endif
+
+namespace {
+
+constexpr int kLanes = 8;
+
+bool isAsciiLetter(char16_t ch)
+{
+    // Setting bit 5 folds A-Z onto a-z and moves nothing else into that range
+    return char16_t((ch | 0x20) - u'a') < 26;
+}
+
+bool isWordChar(char16_t ch)
+{
+    return isAsciiLetter(ch) || ch == u'\'';
+}
+
+bool isSpace(char16_t ch)
+{
+    if (ch < 0x80) {
+        return ch == u' ' || (ch >= u'\t' && ch <= u'\r');
+    }
+    return QChar(ch).isSpace();
+}
+
+bool isLetterOrNumber(char16_t ch)
+{
+    if (ch < 0x80) {
+        return isAsciiLetter(ch) || (ch >= u'0' && ch <= u'9');
+    }
+    return QChar(ch).isLetterOrNumber();
+}
+
+// Bit i of each mask describes unit i of the eight starting at p
+struct LaneMasks {
+    unsigned letters = 0;
+    unsigned wordChars = 0;
+    unsigned spaces = 0;
+    unsigned nonAscii = 0;
+};
+
+#if defined(SCREENQT_TOKENIZER_SSE2)
+unsigned toBits(__m128i lanes)
+{
+    return unsigned(_mm_movemask_epi8(_mm_packs_epi16(lanes, _mm_setzero_si128()))) & 0xffu;
+}
+
+LaneMasks classify(const char16_t *p)
+{
+    const __m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    // Unsigned x <= limit as a saturating subtraction reaching zero
+    auto atMost = [](__m128i x, short limit) {
+        return _mm_cmpeq_epi16(_mm_subs_epu16(x, _mm_set1_epi16(limit)), _mm_setzero_si128());
+    };
+    const __m128i folded = _mm_sub_epi16(_mm_or_si128(units, _mm_set1_epi16(0x20)), _mm_set1_epi16('a'));
+    const __m128i letters = atMost(folded, 25);
+    const __m128i apostrophes = _mm_cmpeq_epi16(units, _mm_set1_epi16('\''));
+    const __m128i controls = atMost(_mm_sub_epi16(units, _mm_set1_epi16('\t')), '\r' - '\t');
+    const __m128i spaces = _mm_or_si128(_mm_cmpeq_epi16(units, _mm_set1_epi16(' ')), controls);
+    const __m128i ascii = atMost(units, 0x7f);
+
+    LaneMasks masks;
+    masks.letters = toBits(letters);
+    masks.wordChars = toBits(_mm_or_si128(letters, apostrophes));
+    masks.spaces = toBits(spaces);
+    masks.nonAscii = ~toBits(ascii) & 0xffu;
+    return masks;
+}
+#elif defined(SCREENQT_TOKENIZER_NEON)
+unsigned toBits(uint16x8_t lanes)
+{
+    static const uint16_t kBits[kLanes] = {1, 2, 4, 8, 16, 32, 64, 128};
+    return vaddvq_u16(vandq_u16(lanes, vld1q_u16(kBits)));
+}
+
+LaneMasks classify(const char16_t *p)
+{
+    const uint16x8_t units = vld1q_u16(reinterpret_cast<const uint16_t *>(p));
+    const uint16x8_t folded = vsubq_u16(vorrq_u16(units, vdupq_n_u16(0x20)), vdupq_n_u16('a'));
+    const uint16x8_t letters = vcleq_u16(folded, vdupq_n_u16(25));
+    const uint16x8_t apostrophes = vceqq_u16(units, vdupq_n_u16('\''));
+    const uint16x8_t controls = vcleq_u16(vsubq_u16(units, vdupq_n_u16('\t')), vdupq_n_u16('\r' - '\t'));
+    const uint16x8_t spaces = vorrq_u16(vceqq_u16(units, vdupq_n_u16(' ')), controls);
+
+    LaneMasks masks;
+    masks.letters = toBits(letters);
+    masks.wordChars = toBits(vorrq_u16(letters, apostrophes));
+    masks.spaces = toBits(spaces);
+    masks.nonAscii = toBits(vcgtq_u16(units, vdupq_n_u16(0x7f)));
+    return masks;
+}
+#else
+LaneMasks classify(const char16_t *p)
+{
+    LaneMasks masks;
+    for (int i = 0; i < kLanes; ++i) {
+        const unsigned bit = 1u << i;
+        masks.letters |= isAsciiLetter(p[i]) ? bit : 0;
+        masks.wordChars |= isWordChar(p[i]) ? bit : 0;
+        masks.spaces |= (p[i] < 0x80 && isSpace(p[i])) ? bit : 0;
+        masks.nonAscii |= p[i] >= 0x80 ? bit : 0;
+    }
+    return masks;
+}
+#endif
+
+const char16_t *units(QStringView text)
+{
+    return reinterpret_cast<const char16_t *>(text.utf16());
+}
+
+int findLetter(QStringView text, int from)
+{
+    const char16_t *p = units(text);
+    const int size = int(text.size());
+    int i = from;
+    for (; i + kLanes <= size; i += kLanes) {
+        if (const unsigned letters = classify(p + i).letters) {
+            return i + qCountTrailingZeroBits(letters);
+        }
+    }
+    while (i < size && !isAsciiLetter(p[i])) {
+        ++i;
+    }
+    return i;
+}
+
+int skipWordChars(QStringView text, int from)
+{
+    const char16_t *p = units(text);
+    const int size = int(text.size());
+    int i = from;
+    for (; i + kLanes <= size; i += kLanes) {
+        if (const unsigned others = ~classify(p + i).wordChars & 0xffu) {
+            return i + qCountTrailingZeroBits(others);
+        }
+    }
+    while (i < size && isWordChar(p[i])) {
+        ++i;
+    }
+    return i;
+}
+
+} // namespace
+
+namespace TextTokenizer {
+
+bool SpellingWords::next(Token &token)
+{
+    const int start = findLetter(m_text, m_position);
+    if (start >= m_text.size()) {
+        m_position = int(m_text.size());
+        return false;
+    }
+    m_position = skipWordChars(m_text, start + 1);
+    token.start = start;
+    token.length = m_position - start;
+    return true;
+}
+
+int countWords(QStringView text)
+{
+    const char16_t *p = units(text);
+    const int size = int(text.size());
+    int count = 0;
+    bool previousSpace = true;
+    int i = 0;
+    for (; i + kLanes <= size; i += kLanes) {
+        const LaneMasks masks = classify(p + i);
+        if (masks.nonAscii) {
+            // Rare outside dialogue in other scripts; classify the unit one at a time
+            for (int lane = 0; lane < kLanes; ++lane) {
+                const bool space = isSpace(p[i + lane]);
+                count += previousSpace && !space;
+                previousSpace = space;
+            }
+            continue;
+        }
+        // A word starts at each non-space unit whose predecessor is a space
+        const unsigned spacesBefore = ((masks.spaces << 1) | (previousSpace ? 1u : 0u)) & 0xffu;
+        count += qPopulationCount(~masks.spaces & spacesBefore & 0xffu);
+        previousSpace = masks.spaces & 0x80u;
+    }
+    for (; i < size; ++i) {
+        const bool space = isSpace(p[i]);
+        count += previousSpace && !space;
+        previousSpace = space;
+    }
+    return count;
+}
+
+bool isWholeWord(QStringView text, int start, int length)
+{
+    const int end = start + length;
+    return (start == 0 || !isLetterOrNumber(text[start - 1].unicode()))
+        && (end >= text.size() || !isLetterOrNumber(text[end].unicode()));
+}
+
+} // namespace TextTokenizer
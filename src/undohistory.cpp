@@ -0,0 +1,225 @@
+#include "undohistory.h"
+
+#include <algorithm>
+
+UndoHistory::UndoHistory(QObject *parent)
+    : QObject(parent)
+{
+}
+
+UndoHistory::~UndoHistory() = default;
+
+void UndoHistory::setCheckpointCapture(std::function<QByteArray()> capture)
+{
+    m_capture = std::move(capture);
+}
+
+void UndoHistory::setCheckpointRestore(std::function<void(const QByteArray &)> restore)
+{
+    m_restore = std::move(restore);
+}
+
+void UndoHistory::setMemoryBudget(qsizetype bytes)
+{
+    m_memoryBudget = bytes;
+    compact();
+    updateAvailability();
+}
+
+void UndoHistory::push(QUndoCommand *command)
+{
+    std::unique_ptr<QUndoCommand> owned(command);
+
+    // A new command replaces whatever could have been redone
+    const int applied = m_index - m_base;
+    while (int(m_commands.size()) > applied) {
+        m_commandBytes -= m_commandCosts.takeLast();
+        m_commands.pop_back();
+    }
+    dropCheckpointsAfter(m_index);
+
+    // Merging only reads the two commands, so it is settled before redo(): a due checkpoint
+    // can then capture the state in front of a new command, which no later merge changes,
+    // and typing that merges into the top command never serializes the document.
+    QUndoCommand *top = applied > 0 ? m_commands.back().get() : nullptr;
+    const bool merged = top && top->id() != -1 && top->id() == owned->id() && top->mergeWith(owned.get());
+    if (!merged && checkpointDue()) {
+        takeCheckpoint();
+    }
+    owned->redo();
+
+    if (merged) {
+        m_commandBytes -= m_commandCosts.last();
+        m_commandCosts.last() = commandCost(top);
+        m_commandBytes += m_commandCosts.last();
+        // The top command now reaches further, so a checkpoint taken right after it is stale
+        if (!m_checkpoints.isEmpty() && m_checkpoints.last().index == m_index) {
+            m_checkpointBytes -= m_checkpoints.last().data.size();
+            m_checkpoints.removeLast();
+        }
+    } else if (!owned->isObsolete()) {
+        m_commandCosts.append(commandCost(owned.get()));
+        m_commandBytes += m_commandCosts.last();
+        m_commands.push_back(std::move(owned));
+        ++m_index;
+    }
+    compact();
+    updateAvailability();
+}
+
+void UndoHistory::undo()
+{
+    if (!canUndo()) {
+        return;
+    }
+    m_commands[m_index - 1 - m_base]->undo();
+    --m_index;
+    updateAvailability();
+}
+
+void UndoHistory::redo()
+{
+    if (!canRedo()) {
+        return;
+    }
+    m_commands[m_index - m_base]->redo();
+    ++m_index;
+    updateAvailability();
+}
+
+QVector<UndoHistory::HistoryPoint> UndoHistory::historyPoints() const
+{
+    QVector<HistoryPoint> points;
+    points.reserve(m_checkpoints.size());
+    for (const Checkpoint &checkpoint : m_checkpoints) {
+        points.append({checkpoint.index, checkpoint.time});
+    }
+    return points;
+}
+
+bool UndoHistory::restoreTo(int index)
+{
+    if (index < m_base || index > m_base + int(m_commands.size())) {
+        return false;
+    }
+
+    // The nearest checkpoint at or below the target, unless stepping from here is shorter
+    const Checkpoint *nearest = nullptr;
+    for (const Checkpoint &checkpoint : m_checkpoints) {
+        if (checkpoint.index > index) {
+            break;
+        }
+        nearest = &checkpoint;
+    }
+    const int stepsFromHere = qAbs(index - m_index);
+    if (m_restore && nearest && index - nearest->index < stepsFromHere) {
+        m_restore(qUncompress(nearest->data));
+        m_index = nearest->index;
+    }
+
+    while (m_index > index) {
+        m_commands[m_index - 1 - m_base]->undo();
+        --m_index;
+    }
+    while (m_index < index) {
+        m_commands[m_index - m_base]->redo();
+        ++m_index;
+    }
+    updateAvailability();
+    return true;
+}
+
+void UndoHistory::clear()
+{
+    m_commands.clear();
+    m_commandCosts.clear();
+    m_checkpoints.clear();
+    m_sinceCheckpoint.invalidate();
+    m_commandBytes = 0;
+    m_checkpointBytes = 0;
+    m_base = 0;
+    m_index = 0;
+    updateAvailability();
+}
+
+qsizetype UndoHistory::commandCost(const QUndoCommand *command)
+{
+    if (const auto *sized = dynamic_cast<const SizedUndoCommand *>(command)) {
+        return sized->memoryCost();
+    }
+    qsizetype cost = sizeof(QUndoCommand);
+    for (int i = 0; i < command->childCount(); ++i) {
+        cost += commandCost(command->child(i));
+    }
+    return cost;
+}
+
+bool UndoHistory::checkpointDue() const
+{
+    if (!m_capture) {
+        return false;
+    }
+    // The state history starts from, so restoreTo() reaches back to it
+    if (m_checkpoints.isEmpty()) {
+        return true;
+    }
+    const int sinceLast = m_index - m_checkpoints.last().index;
+    return sinceLast >= kCheckpointInterval
+        || (sinceLast > 0 && m_sinceCheckpoint.hasExpired(qint64(kCheckpointMinutes) * 60 * 1000));
+}
+
+void UndoHistory::takeCheckpoint()
+{
+    Checkpoint checkpoint;
+    checkpoint.index = m_index;
+    checkpoint.data = qCompress(m_capture());
+    checkpoint.time = QDateTime::currentDateTime();
+    m_sinceCheckpoint.start();
+    m_checkpointBytes += checkpoint.data.size();
+    m_checkpoints.append(checkpoint);
+}
+
+void UndoHistory::dropCheckpointsAfter(int index)
+{
+    while (!m_checkpoints.isEmpty() && m_checkpoints.last().index > index) {
+        m_checkpointBytes -= m_checkpoints.last().data.size();
+        m_checkpoints.removeLast();
+    }
+}
+
+void UndoHistory::compact()
+{
+    while (memoryUsage() > m_memoryBudget) {
+        // The oldest checkpoint above the floor that the current state can still undo to
+        const auto next = std::find_if(m_checkpoints.cbegin(), m_checkpoints.cend(), [this](const Checkpoint &checkpoint) {
+            return checkpoint.index > m_base && checkpoint.index <= m_index;
+        });
+        if (next == m_checkpoints.cend()) {
+            break;
+        }
+        const int newBase = next->index;
+        const int dropped = newBase - m_base;
+        for (int i = 0; i < dropped; ++i) {
+            m_commandBytes -= m_commandCosts.at(i);
+        }
+        m_commands.erase(m_commands.begin(), m_commands.begin() + dropped);
+        m_commandCosts.remove(0, dropped);
+        while (m_checkpoints.first().index < newBase) {
+            m_checkpointBytes -= m_checkpoints.first().data.size();
+            m_checkpoints.removeFirst();
+        }
+        m_base = newBase;
+    }
+}
+
+void UndoHistory::updateAvailability()
+{
+    if (m_canUndo != canUndo()) {
+        m_canUndo = canUndo();
+        emit canUndoChanged(m_canUndo);
+    }
+    if (m_canRedo != canRedo()) {
+        m_canRedo = canRedo();
+        emit canRedoChanged(m_canRedo);
+    }
+}
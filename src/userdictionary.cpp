@@ -0,0 +1,78 @@
+#include "userdictionary.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <algorithm>
+
+UserDictionary::UserDictionary(const QString &path)
+    : m_path(path)
+{
+    if (m_path.isEmpty()) {
+        return;
+    }
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return;
+    }
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        const QString word = in.readLine().trimmed().toLower();
+        if (!word.isEmpty()) {
+            m_words.append(word);
+        }
+    }
+    std::sort(m_words.begin(), m_words.end());
+    m_words.erase(std::unique(m_words.begin(), m_words.end()), m_words.end());
+}
+
+QString UserDictionary::defaultPath()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).filePath("user_dictionary.txt");
+}
+
+QStringList::const_iterator UserDictionary::lowerBound(QStringView word) const
+{
+    return std::lower_bound(m_words.cbegin(), m_words.cend(), word,
+                            [](const QString &entry, QStringView key) { return QStringView(entry).compare(key) < 0; });
+}
+
+bool UserDictionary::contains(QStringView word) const
+{
+    QReadLocker locker(&m_lock);
+    const auto it = lowerBound(word);
+    return it != m_words.cend() && QStringView(*it) == word;
+}
+
+bool UserDictionary::add(const QString &word)
+{
+    QWriteLocker locker(&m_lock);
+    const auto it = lowerBound(word);
+    if (word.isEmpty() || (it != m_words.cend() && *it == word)) {
+        return false;
+    }
+    m_words.insert(it - m_words.cbegin(), word);
+
+    if (m_path.isEmpty()) {
+        return true;
+    }
+    if (!m_file.isOpen()) {
+        QDir().mkpath(QFileInfo(m_path).absolutePath());
+        m_file.setFileName(m_path);
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+            qWarning() << "[Spellcheck] Cannot save user dictionary:" << m_file.errorString();
+            return true;
+        }
+    }
+    m_file.write(word.toUtf8() + '\n');
+    m_file.flush();
+    return true;
+}
+
+QStringList UserDictionary::words() const
+{
+    QReadLocker locker(&m_lock);
+    return m_words;
+}
@@ -0,0 +1,99 @@
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "latencytrace.h"
+#include "pageview.h"
+#include "scripteditor.h"
+
+class LatencyTraceTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init()
+    {
+        LatencyTrace::instance().setChromeTracePath(QString());
+        LatencyTrace::instance().reset();
+    }
+
+    void percentilesComeFromTheHistogram()
+    {
+        LatencyTrace &trace = LatencyTrace::instance();
+        // 90 fast samples at 10us and 10 slow ones at 5ms
+        for (int i = 0; i < 90; ++i) {
+            trace.record(LatencyTrace::KeyPress, 0, 10 * 1000);
+        }
+        for (int i = 0; i < 10; ++i) {
+            trace.record(LatencyTrace::KeyPress, 0, 5 * 1000 * 1000);
+        }
+
+        const LatencyTrace::StageStats stats = trace.stats(LatencyTrace::KeyPress);
+        QCOMPARE(stats.count, qint64(100));
+        // Buckets are a quarter octave wide, so a percentile is within 19% above the sample
+        QVERIFY2(stats.p50Us >= 10.0 && stats.p50Us < 10.0 * 1.19, qPrintable(QString::number(stats.p50Us)));
+        // and never above the slowest sample
+        QCOMPARE(stats.p95Us, 5000.0);
+        QCOMPARE(stats.maxUs, 5000.0);
+        QCOMPARE(trace.stats(LatencyTrace::Layout).count, qint64(0));
+    }
+
+    void nestedScopesOfOneStageCountOnce()
+    {
+        {
+            LatencyTrace::Scope outer(LatencyTrace::UndoCommand);
+            LatencyTrace::Scope inner(LatencyTrace::UndoCommand);
+        }
+        QCOMPARE(LatencyTrace::instance().stats(LatencyTrace::UndoCommand).count, qint64(1));
+    }
+
+    void typingRecordsEveryEditorStage()
+    {
+        PageView pv;
+        pv.show();
+        QVERIFY(QTest::qWaitForWindowExposed(&pv));
+        LatencyTrace::instance().reset();
+
+        QTest::keyClicks(pv.editor(), "INT. HOUSE");
+        QCoreApplication::processEvents();
+
+        const LatencyTrace &trace = LatencyTrace::instance();
+        QCOMPARE(trace.stats(LatencyTrace::KeyPress).count, qint64(10));
+        QVERIFY(trace.stats(LatencyTrace::UndoCommand).count >= 10);
+        QVERIFY(trace.stats(LatencyTrace::Layout).count >= 10);
+        QVERIFY(trace.stats(LatencyTrace::FindMatches).count >= 10);
+    }
+
+    void chromeTraceIsValidJson()
+    {
+        QTemporaryDir tempDir;
+        QVERIFY(tempDir.isValid());
+        const QString tracePath = tempDir.filePath("trace.json");
+
+        LatencyTrace &trace = LatencyTrace::instance();
+        trace.setChromeTracePath(tracePath);
+        trace.record(LatencyTrace::KeyPress, 1000, 250 * 1000);
+        trace.record(LatencyTrace::Layout, 2000, 100 * 1000);
+        QVERIFY(trace.writeChromeTrace(tracePath));
+
+        QFile file(tracePath);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QJsonParseError error;
+        const QJsonDocument json = QJsonDocument::fromJson(file.readAll(), &error);
+        QCOMPARE(error.error, QJsonParseError::NoError);
+
+        const QJsonArray events = json.object().value("traceEvents").toArray();
+        QCOMPARE(events.size(), 2);
+        const QJsonObject first = events.at(0).toObject();
+        QCOMPARE(first.value("name").toString(), QString("keyPress"));
+        QCOMPARE(first.value("ph").toString(), QString("X"));
+        QCOMPARE(first.value("ts").toDouble(), 1.0);
+        QCOMPARE(first.value("dur").toDouble(), 250.0);
+    }
+};
+
+QTEST_MAIN(LatencyTraceTests)
+#include "latencytrace_test.moc"
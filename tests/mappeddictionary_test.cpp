@@ -0,0 +1,127 @@
+#include <QFile>
+#include <QObject>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "mappeddictionary.h"
+#include "mappedspellchecker.h"
+
+class MappedDictionaryTests : public QObject {
+    Q_OBJECT
+
+private:
+    QString compileWords(const QStringList &words, const QString &name = "words.sqtdict")
+    {
+        const QString path = m_dir.filePath(name);
+        QString error;
+        if (!MappedDictionary::compile(words, path, &error)) {
+            qWarning("%s", qPrintable(error));
+            return QString();
+        }
+        return path;
+    }
+
+    QTemporaryDir m_dir;
+
+private slots:
+    void compiledDictionaryAnswersMembership()
+    {
+        const QStringList words = {"door", "doors", "floor", "floors", "Window", "windows",
+                                   "detective", "door", "café", "o'clock"};
+        const QString path = compileWords(words);
+        QVERIFY(!path.isEmpty());
+
+        MappedDictionary dictionary;
+        QVERIFY(dictionary.open(path));
+        QCOMPARE(dictionary.wordCount(), 9);
+        for (const QString &word : {"door", "doors", "floor", "window", "windows", "detective", "café", "o'clock"}) {
+            QVERIFY2(dictionary.contains(word), qPrintable(word));
+        }
+        for (const QString &word : {"do", "doo", "doorss", "flo", "wind", "detectives", ""}) {
+            QVERIFY2(!dictionary.contains(word), qPrintable(word));
+        }
+    }
+
+    void suffixesAreShared()
+    {
+        // Every word ends in "ing": a DAWG stores that tail once, a trie once per word
+        QStringList words;
+        for (const QString &stem : {"walk", "talk", "stalk", "balk", "chalk", "mark", "park", "bark"}) {
+            words << stem + "ing";
+        }
+        const QString path = compileWords(words);
+        QVERIFY(!path.isEmpty());
+        int trieNodes = 1;
+        for (const QString &word : words) {
+            trieNodes += word.size();
+        }
+        // Smaller than the header plus the trie's nodes alone, before counting any edges
+        QVERIFY(QFile(path).size() < 28 + trieNodes * 8);
+    }
+
+    void suggestionsComeWithinTwoEdits()
+    {
+        const QString path = compileWords({"door", "doors", "dorm", "odor", "floor", "detective", "detectives"});
+        MappedDictionary dictionary;
+        QVERIFY(dictionary.open(path));
+
+        QCOMPARE(dictionary.suggestions(u"dor", 2, 6), QStringList({"door", "dorm", "odor", "doors"}));
+        QCOMPARE(dictionary.suggestions(u"detectiev", 2, 6), QStringList({"detective", "detectives"}));
+        QCOMPARE(dictionary.suggestions(u"dor", 2, 2), QStringList({"door", "dorm"}));
+        QVERIFY(dictionary.suggestions(u"zzzz", 2, 6).isEmpty());
+    }
+
+    void readsHunspellDictionaries()
+    {
+        const QString dicPath = m_dir.filePath("en_TEST.dic");
+        QFile dic(dicPath);
+        QVERIFY(dic.open(QIODevice::WriteOnly | QIODevice::Text));
+        dic.write("3\nscreenplay/S\nslugline/SM\tpo:noun\nmontage\n");
+        dic.close();
+
+        const QStringList words = MappedDictionary::readWordList(dicPath);
+        QCOMPARE(words, QStringList({"screenplay", "slugline", "montage"}));
+    }
+
+    void rejectsDamagedFiles()
+    {
+        const QString path = compileWords({"door", "floor"});
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QByteArray bytes = file.readAll();
+        bytes.chop(4);
+        file.resize(0);
+        file.write(bytes);
+        file.close();
+
+        MappedDictionary dictionary;
+        QString error;
+        QVERIFY(!dictionary.open(path, &error));
+        QVERIFY(!error.isEmpty());
+        QVERIFY(!dictionary.contains(u"door"));
+    }
+
+    void checkerFlagsUnknownWordsAndLearnsNewOnes()
+    {
+        const QString path = compileWords({"the", "detective", "opens", "door", "slowly"});
+        MappedDictionarySpellChecker checker(path);
+        QVERIFY(checker.isAvailable());
+        QVERIFY(checker.supportsBackgroundChecks());
+
+        QList<Misspelling> misspellings = checker.checkText("The detectve opens the dor slowly. INT.");
+        QCOMPARE(misspellings.size(), 2);
+        QCOMPARE(misspellings.at(0).word, QString("detectve"));
+        QCOMPARE(checker.suggestionsFor("detectve"), QStringList({"detective"}));
+
+        checker.addWord("Detectve");
+        misspellings = checker.checkText("The detectve opens the dor slowly.");
+        QCOMPARE(misspellings.size(), 1);
+        QVERIFY(checker.suggestionsFor("detectiv").contains("detectve"));
+
+        MappedDictionarySpellChecker missing(m_dir.filePath("missing.sqtdict"));
+        QVERIFY(!missing.isAvailable());
+    }
+};
+
+QTEST_MAIN(MappedDictionaryTests)
+#include "mappeddictionary_test.moc"
@@ -6,11 +6,21 @@
 #include <QTextBlock>
 #include <QAbstractTextDocumentLayout>
 #include <QFont>
+#include <QFontInfo>
+#include <QFontDatabase>
+#include <QFontMetricsF>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QStandardPaths>
+#include <QTextLayout>
 #include <QFile>
 #include <QTemporaryDir>
 #include <QSet>
+#include "linegridpaginator.h"
 #include "pageview.h"
+#include "paginationmodel.h"
 #include "scripteditor.h"
+#include "scriptgenerator.h"
 
 class PageViewTests : public QObject {
     Q_OBJECT
@@ -40,25 +50,78 @@ private:
     }
 
     int contentStartYAt(QTextDocument* doc, int idx) {
+        const QTextBlock b = doc->findBlockByNumber(idx);
+        return static_cast<int>(doc->documentLayout()->blockBoundingRect(b).top());
+    }
+
+    struct ExpectedLayout {
+        QVector<int> blockPages; // Page each block starts on
+        QVector<int> blockTops;  // Content top in document coordinates
+        int pageCount = 1;
+    };
+
+    // Independent full walk over the document: a block that does not fit starts the next
+    // page without its top margin, and a block taller than the space left continues by line
+    ExpectedLayout expectedLayout(PageView& pv) {
+        QTextDocument* doc = pv.editor()->document();
+        const int printableH = pv.printableHeight();
+        const int pageAdvance = pv.pageHeight() + pv.pageGapPx();
+
+        ExpectedLayout expected;
+        int page = 0;
         int y = 0;
-        int blockIndex = 0;
         for (QTextBlock b = doc->begin(); b.isValid(); b = b.next()) {
-            if (blockIndex == idx) {
-                // Add this block's top margin to get to where content starts
-                QTextBlockFormat fmt = b.blockFormat();
-                int topMargin = static_cast<int>(fmt.topMargin());
-                return y + topMargin;
+            const int spaceBefore = qRound(b.blockFormat().topMargin());
+            const QTextLayout *layout = b.layout();
+            int h = 0;
+            for (int i = 0; i < layout->lineCount(); ++i) {
+                h += static_cast<int>(std::ceil(layout->lineAt(i).height()));
+            }
+            if (y > 0 && y + spaceBefore + h > printableH) {
+                ++page;
+                y = 0;
+            }
+            const int relY = (y == 0) ? 0 : y + spaceBefore;
+            expected.blockPages.append(page);
+            expected.blockTops.append(page * pageAdvance + relY);
+            y = relY + h;
+            if (y > printableH) {
+                y = relY;
+                for (int i = 0; i < layout->lineCount(); ++i) {
+                    const int lineHeight = static_cast<int>(std::ceil(layout->lineAt(i).height()));
+                    if (y > 0 && y + lineHeight > printableH) {
+                        ++page;
+                        y = 0;
+                    }
+                    y += lineHeight;
+                }
             }
-            QTextBlockFormat fmt = b.blockFormat();
-            int topMargin = static_cast<int>(fmt.topMargin());
-            int blockHeight = static_cast<int>(std::ceil(doc->documentLayout()->blockBoundingRect(b).height()));
-            y += topMargin + blockHeight;
-            blockIndex++;
         }
-        return y;
+        expected.pageCount = page + 1;
+        return expected;
+    }
+
+    // A fixed-pitch face at 10 characters per inch, the pitch of 12 pt Courier, and a hair
+    // under so a full-width line does not overflow on rounding. Fixed here rather than taken
+    // from whatever Courier is installed, so the grid comparisons run on every machine.
+    void useLineGridFont(ScriptEditor* editor) {
+        QFont font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+        font.setHintingPreference(QFont::PreferNoHinting);
+        font.setPointSizeF(12.0);
+        const qreal dpi = QGuiApplication::primaryScreen()->logicalDotsPerInchX();
+        const qreal advance = QFontMetricsF(font, editor).horizontalAdvance(QLatin1Char('M'));
+        QVERIFY(advance > 0.0);
+        font.setPointSizeF(12.0 * (dpi / 10.0 * 0.999) / advance);
+        editor->setFont(font);
+        QVERIFY2(QFontInfo(editor->font()).fixedPitch(), "The system fixed font is not fixed-pitch");
     }
 
 private slots:
+    void initTestCase() {
+        // Editors load the user dictionary; keep the real one out of these results
+        QStandardPaths::setTestModeEnabled(true);
+    }
+
     void defaultScriptFontMatchesFadeInBaseline() {
         PageView pv;
         QCoreApplication::processEvents();
@@ -70,30 +133,37 @@ private slots:
                      .toUtf8().constData());
     }
 
-    void zoomScalesFromEditorBaselineAndResetsCorrectly() {
+    void zoomScalesViewWithoutReformatting() {
         PageView pv;
+        insertLines(pv.editor(), 200);
         QCoreApplication::processEvents();
 
         const qreal baseSize = pv.editor()->font().pointSizeF();
-        QVERIFY2(baseSize > 0.0, "Editor base font size should be positive");
+        const int basePageCount = pv.pageCount();
+        const int basePageHeight = pv.pageHeight();
+        QVERIFY2(basePageCount >= 3, "Expected a multi-page script");
 
         pv.setZoomSteps(1);
         QCoreApplication::processEvents();
-        const qreal zoomInSize = pv.editor()->font().pointSizeF();
-        QVERIFY2(std::abs(zoomInSize - (baseSize * 1.1)) < 0.02,
-                 QString("Expected zoomed font size %1, got %2")
-                     .arg(baseSize * 1.1, 0, 'f', 2)
-                     .arg(zoomInSize, 0, 'f', 2)
+        QVERIFY2(std::abs(pv.zoomFactor() - 1.1) < 0.001,
+                 QString("Expected zoom factor 1.10, got %1")
+                     .arg(pv.zoomFactor(), 0, 'f', 3)
                      .toUtf8().constData());
+        QCOMPARE(pv.editor()->font().pointSizeF(), baseSize);
+        QCOMPARE(pv.pageHeight(), basePageHeight);
+        QCOMPARE(pv.pageCount(), basePageCount);
+        QCOMPARE(pv.pagePrintableStartY(1) - pv.pagePrintableStartY(0),
+                 qRound((pv.pageHeight() + pv.pageGapPx()) * pv.zoomFactor()));
+
+        pv.setZoomSteps(-2);
+        QCoreApplication::processEvents();
+        QCOMPARE(pv.pageCount(), basePageCount);
 
         pv.setZoomSteps(0);
         QCoreApplication::processEvents();
-        const qreal resetSize = pv.editor()->font().pointSizeF();
-        QVERIFY2(std::abs(resetSize - baseSize) < 0.01,
-                 QString("Expected reset font size %1, got %2")
-                     .arg(baseSize, 0, 'f', 2)
-                     .arg(resetSize, 0, 'f', 2)
-                     .toUtf8().constData());
+        QCOMPARE(pv.zoomFactor(), 1.0);
+        QCOMPARE(pv.editor()->font().pointSizeF(), baseSize);
+        QCOMPARE(pv.pageCount(), basePageCount);
     }
 
     void noPageBreaksForSmallContent() {
@@ -122,17 +192,18 @@ private slots:
 
         QVERIFY2(pv.pageCount() >= 2, "Expected multiple pages after large insert");
 
-        // At least one block should have a large top margin (page break spacing)
-        bool foundBreakMargin = false;
+        // The layout moves the first block of page 2 to that page's printable top...
         QTextDocument* doc = pv.editor()->document();
+        const PaginationModel &model = pv.pagination();
+        const int firstOnPage2 = model.firstBlockOfPage(1);
+        QVERIFY2(firstOnPage2 > 0, "Expected a block starting page 2");
+        QCOMPARE(contentStartYAt(doc, firstOnPage2), model.pageYOffset(1));
+
+        // ...without writing page-break spacing into any block format
         for (QTextBlock block = doc->begin(); block.isValid(); block = block.next()) {
             int topMargin = static_cast<int>(block.blockFormat().topMargin());
-            if (topMargin >= pv.pageGapPx()) {
-                foundBreakMargin = true;
-                break;
-            }
+            QVERIFY2(topMargin < pv.pageGapPx(), "Pagination should not change block margins");
         }
-        QVERIFY2(foundBreakMargin, "No page-break margins found after exceeding printable height");
     }
 
     void marginsCleanedAfterContentReduction() {
@@ -178,6 +249,17 @@ private slots:
 
         QVERIFY2(pv.pageCount() >= 2, "Expected long dialogue to span multiple pages");
 
+        // The dialogue is taller than a page, so it continues line by line at the next printable top
+        const PaginationModel &model = pv.pagination();
+        const int dialogueNumber = dialogueBlock.blockNumber();
+        const QVector<int> splitLines = model.blockSplitLines(dialogueNumber);
+        QVERIFY2(!splitLines.isEmpty(), "Expected the dialogue block to be split by line");
+        const QTextDocument *doc = pv.editor()->document();
+        const qreal dialogueTop = doc->documentLayout()->blockBoundingRect(dialogueBlock).top();
+        const QTextLine firstContinued = dialogueBlock.layout()->lineAt(splitLines.first());
+        QCOMPARE(static_cast<int>(dialogueTop + firstContinued.y()),
+                 model.pageYOffset(model.pageForBlock(dialogueNumber) + 1));
+
         const QVector<PageView::ContinuationMarker> markers = pv.continuationMarkers();
         QVERIFY2(!markers.isEmpty(), "Expected continuation markers for split dialogue");
 
@@ -226,21 +308,12 @@ private slots:
             cur.beginEditBlock();
             for (QTextBlock b = doc->begin(); b.isValid(); b = b.next()) {
                 QTextBlockFormat fmt = b.blockFormat();
-                // Clear the page break margin property before setting topMargin to 0
-                fmt.setProperty(QTextFormat::UserProperty + 1, 0);
                 fmt.setTopMargin(0);
                 cur.setPosition(b.position());
                 cur.setBlockFormat(fmt);
             }
             cur.endEditBlock();
         }
-        // Trigger enforcePageBreaks via benign text change
-        {
-            QTextCursor cur(doc);
-            cur.movePosition(QTextCursor::End);
-            cur.insertText(" ");
-            cur.deletePreviousChar();
-        }
         QCoreApplication::processEvents();
 
         // Get block heights and verify document structure
@@ -267,44 +340,32 @@ private slots:
         QVERIFY2(pageBreakAfterBlock.size() > 0, "Should have at least one page break");
         
         // Now verify actual block positions match expected
-        const int gap = pv.pageGapPx();
-        const int topMargin = pv.pageTopMarginPx();
-        const int bottomMargin = pv.pageBottomMarginPx();  // Use accessor for accuracy
-        const int pageBreakDistance = printableH + bottomMargin + gap + topMargin;  // gap IS included
-        
-        int expectedY = 0;
-        int pageStartY = 0;  // Y coordinate of the start of the current page
-        
+        const int pageAdvance = pv.pageHeight() + pv.pageGapPx();
+
+        int page = 0;
+        int posInPage = 0;  // Content already on the current page
+
         for (int blockIndex = 0; blockIndex < numBlocks; blockIndex++) {
-            // Check if this block should have gotten a page break margin
-            // A block gets a page break margin if it would overflow the current page
-            int posInPage = expectedY - pageStartY;
+            // A block that would overflow the current page starts at the next page's printable top
             bool needsPageBreak = false;
-            int pageBreakMargin = 0;
-            
             if (posInPage + blockHeights[blockIndex] > printableH && posInPage > 0) {
-                // This block would overflow - calculate page break margin
-                // Next page's printable area starts at: pageStartY + pageBreakDistance
-                int nextPagePrintableStart = pageStartY + pageBreakDistance;
-                pageBreakMargin = nextPagePrintableStart - expectedY;
-                expectedY += pageBreakMargin;
-                pageStartY += printableH + bottomMargin;  // Update pageStartY for next iteration (no gap)
+                ++page;
+                posInPage = 0;
                 needsPageBreak = true;
             }
-            
-            // This block starts at expectedY (after any page break margin)
+            const int expectedY = page * pageAdvance + posInPage;
+
             int actualY = contentStartYAt(doc, blockIndex);
-            QTextBlock b = doc->begin();
-            for (int i = 0; i < blockIndex && b.isValid(); i++) b = b.next();
+            QTextBlock b = doc->findBlockByNumber(blockIndex);
             QString blockText = b.isValid() ? b.text().left(20) : "";
-            
-            QVERIFY2(actualY == expectedY, 
-                QString("Block %1 ('%2'): expected Y=%3, actual Y=%4, needsPageBreak=%5, pageBreakMargin=%6")
+
+            QVERIFY2(actualY == expectedY,
+                QString("Block %1 ('%2'): expected Y=%3, actual Y=%4, needsPageBreak=%5, page=%6")
                 .arg(blockIndex).arg(blockText).arg(expectedY).arg(actualY)
-                .arg(needsPageBreak).arg(pageBreakMargin)
+                .arg(needsPageBreak).arg(page)
                 .toUtf8().constData());
-            
-            expectedY += blockHeights[blockIndex];
+
+            posInPage += blockHeights[blockIndex];
         }
     }
     
@@ -402,16 +463,12 @@ private slots:
         int actualPage2BlockStart = -1;
         
         int blockIdx = 0;
-        int firstBlockBaseMargin = 0;
         for (QTextBlock block = doc->begin(); block.isValid(); block = block.next()) {
             int contentStartY = contentStartYAt(doc, blockIdx);
             
             if (contentStartY >= expectedPage2Start) {
                 firstBlockOnPage2Index = blockIdx;
                 actualPage2BlockStart = contentStartY;
-                int topMargin = static_cast<int>(block.blockFormat().topMargin());
-                int pageBreakMargin = block.blockFormat().property(QTextFormat::UserProperty + 1).toInt();
-                firstBlockBaseMargin = topMargin - pageBreakMargin;
                 break;
             }
             blockIdx++;
@@ -419,66 +476,272 @@ private slots:
         
         QVERIFY2(firstBlockOnPage2Index >= 0, "Should have found a block on page 2");
         
-        int expectedPage2BlockStart = expectedPage2Start + firstBlockBaseMargin;
-        QString msg = QString("First block on page 2 (index %1) should start at Y=%2 (printable start + base margin), actual Y=%3")
+        QString msg = QString("First block on page 2 (index %1) should start at Y=%2 (printable start), actual Y=%3")
             .arg(firstBlockOnPage2Index)
-            .arg(expectedPage2BlockStart)
+            .arg(expectedPage2Start)
             .arg(actualPage2BlockStart);
         
-        // The first block on page 2 should start at printable start plus its top margin
-        QVERIFY2(actualPage2BlockStart == expectedPage2BlockStart, qPrintable(msg));
+        // Element spacing is dropped at the top of a page
+        QVERIFY2(actualPage2BlockStart == expectedPage2Start, qPrintable(msg));
     }
     
-    void pageBreakMarginIsCorrect() {
+    void everyPageStartsAtItsPrintableTop() {
         PageView pv;
         ScriptEditor* editor = pv.editor();
         QTextDocument* doc = editor->document();
         
-        // Insert enough lines to trigger a page break
-        const int numBlocks = 60;
+        // Insert enough lines to span several pages
+        const int numBlocks = 200;
         insertLines(editor, numBlocks);
         QCoreApplication::processEvents();
         
-        QVERIFY2(pv.pageCount() >= 2, "Should have at least 2 pages");
-        
-        // The page break margin ensures the first block on the next page starts at the
-        // beginning of that page's printable area. The gap between pages is purely visual.
-        int pageHeight = pv.pageHeight();
-        int printableH = pv.printableHeight();
-        int topMargin = pv.pageTopMarginPx();
-        int bottomMargin = pv.pageBottomMarginPx();
-        int pageGap = pv.pageGapPx();
-        
-        // Where the next page's printable area should start in editor coordinates
-        // = 0 (current page start) + 864 (printable) + 97 (bottom margin) + 96 (top margin)
-        // Note: gap is NOT included because it's purely visual
-        int expectedNextPagePrintableStart = printableH + bottomMargin + topMargin;
+        QVERIFY2(pv.pageCount() >= 3, "Should have at least 3 pages");
         
-        // Find the first block with a page break margin
-        int firstBlockWithMarginIndex = -1;
-        int actualPageBreakMargin = 0;
-        int blockIndex = 0;
-        for (QTextBlock block = doc->begin(); block.isValid(); block = block.next()) {
-            int pageBreakMarginProperty = block.blockFormat().property(QTextFormat::UserProperty + 1).toInt();
-            if (pageBreakMarginProperty > 0) {
-                firstBlockWithMarginIndex = blockIndex;
-                actualPageBreakMargin = pageBreakMarginProperty;
-                break;
+        // Page N's printable area starts at N * (page height + gap) in document coordinates;
+        // the gap is skipped by placement, not by padding a block's top margin
+        const PaginationModel &model = pv.pagination();
+        const int pageAdvance = pv.pageHeight() + pv.pageGapPx();
+        for (int page = 0; page < model.pageCount(); ++page) {
+            const int blockNumber = model.firstBlockOfPage(page);
+            QCOMPARE(model.pageYOffset(page), page * pageAdvance);
+            QVERIFY2(contentStartYAt(doc, blockNumber) == model.pageYOffset(page),
+                     QString("Page %1 first block %2 expected Y=%3, actual Y=%4")
+                         .arg(page + 1).arg(blockNumber).arg(model.pageYOffset(page))
+                         .arg(contentStartYAt(doc, blockNumber))
+                         .toUtf8().constData());
+        }
+    }
+
+    void incrementalEditsMatchFullPagination() {
+        PageView pv;
+        ScriptEditor* editor = pv.editor();
+        QTextDocument* doc = editor->document();
+        insertLines(editor, 300);
+        QCoreApplication::processEvents();
+        QVERIFY2(pv.pageCount() >= 3, "Setup: multiple pages expected");
+
+        auto verifyPlacement = [&](const char *step) {
+            const ExpectedLayout expected = expectedLayout(pv);
+            int index = 0;
+            for (QTextBlock b = doc->begin(); b.isValid(); b = b.next(), ++index) {
+                const int actual = static_cast<int>(doc->documentLayout()->blockBoundingRect(b).top());
+                QVERIFY2(actual == expected.blockTops.at(index),
+                         QString("%1: block %2 top expected %3, got %4")
+                             .arg(step).arg(index).arg(expected.blockTops.at(index)).arg(actual)
+                             .toUtf8().constData());
+            }
+            QCOMPARE(pv.pageCount(), expected.pageCount);
+        };
+
+        // Split a block near the top: every later page shifts by a line
+        QTextCursor cur(doc->findBlockByNumber(10));
+        cur.movePosition(QTextCursor::EndOfBlock);
+        cur.insertText("\nInserted line");
+        QCoreApplication::processEvents();
+        verifyPlacement("insert");
+
+        // Grow one block by several lines in the middle of the script
+        cur = QTextCursor(doc->findBlockByNumber(120));
+        cur.movePosition(QTextCursor::EndOfBlock);
+        cur.insertText(QString(" long text").repeated(60));
+        QCoreApplication::processEvents();
+        verifyPlacement("grow");
+
+        // Remove a run of blocks spanning a page boundary
+        QTextBlock from = doc->findBlockByNumber(40);
+        QTextBlock to = doc->findBlockByNumber(90);
+        cur = QTextCursor(doc);
+        cur.setPosition(from.position());
+        cur.setPosition(to.position() + to.length() - 1, QTextCursor::KeepAnchor);
+        cur.removeSelectedText();
+        QCoreApplication::processEvents();
+        verifyPlacement("remove");
+
+        // Reformat every block, as zoom and element changes do
+        editor->formatDocument();
+        QCoreApplication::processEvents();
+        verifyPlacement("reformat");
+    }
+
+    void paginationModelLookupsAgree() {
+        PageView pv;
+        insertLines(pv.editor(), 400);
+        QCoreApplication::processEvents();
+
+        const PaginationModel &model = pv.pagination();
+        QCOMPARE(model.pageCount(), pv.pageCount());
+        QVERIFY2(model.pageCount() >= 4, "Expected at least 4 pages for lookup checks");
+
+        const ExpectedLayout expected = expectedLayout(pv);
+        QCOMPARE(model.pageCount(), expected.pageCount);
+        for (int blockNumber = 0; blockNumber < expected.blockPages.size(); ++blockNumber) {
+            const int page = expected.blockPages.at(blockNumber);
+            if (blockNumber == 0 || page != expected.blockPages.at(blockNumber - 1)) {
+                QCOMPARE(model.firstBlockOfPage(page), blockNumber);
             }
-            blockIndex++;
+            QCOMPARE(model.pageForBlock(blockNumber), page);
+            QCOMPARE(model.blockTop(blockNumber), expected.blockTops.at(blockNumber));
         }
-        
-        QVERIFY2(firstBlockWithMarginIndex >= 0, "Should have found a block with page break margin");
-        
-        // The page break margin should position the block correctly on the next page
-        // Verify it's positive and reasonable (less than the full page advance)
-        QVERIFY2(actualPageBreakMargin > 0, "Page break margin should be positive");
-        
-        qDebug() << "Block" << firstBlockWithMarginIndex << ": pageHeight=" << pageHeight 
-                 << "printableH=" << printableH << "topMargin=" << topMargin
-                 << "bottomMargin=" << bottomMargin << "pageGap=" << pageGap
-                 << "expectedNextPageStart=" << expectedNextPagePrintableStart
-                 << "pageBreakMargin=" << actualPageBreakMargin;
+        QCOMPARE(model.firstBlockOfPage(model.pageCount()), -1);
+        QCOMPARE(model.pageYOffset(2), 2 * (pv.pageHeight() + pv.pageGapPx()));
+
+        // Typing inside a line leaves every page as it was, so the generation consumers
+        // key their caches on holds; a new block moves the blocks after it and advances it
+        const int generation = model.generation();
+        QTextCursor cur(pv.editor()->document());
+        cur.insertText("More ");
+        QCoreApplication::processEvents();
+        QCOMPARE(model.generation(), generation);
+
+        cur.insertText("\n");
+        QCoreApplication::processEvents();
+        QVERIFY(model.generation() > generation);
+    }
+
+    void typingWithinALineKeepsPaginationGeneration() {
+        PageView pv;
+        pv.setDebugMode(true);
+        insertLines(pv.editor(), 400);
+        pv.show();
+        QVERIFY(QTest::qWaitForWindowExposed(&pv));
+        QCoreApplication::processEvents();
+
+        const PaginationModel &model = pv.pagination();
+        const QVector<PaginationModel::PageBreak> breaks = model.pageBreaks();
+        const int generation = model.generation();
+
+        // Mid-document, where the edit starts a walk that reaches later page breaks
+        QTextDocument *doc = pv.editor()->document();
+        QTextCursor cursor(doc->findBlockByNumber(150));
+        cursor.movePosition(QTextCursor::EndOfBlock);
+        pv.editor()->setTextCursor(cursor);
+        pv.editor()->setFocus();
+        QTest::keyClicks(pv.editor(), " ok");
+        QCoreApplication::processEvents();
+
+        QVERIFY(doc->findBlockByNumber(150).text().endsWith(" ok"));
+        QVERIFY(model.pageBreaks() == breaks);
+        QCOMPARE(model.generation(), generation);
+    }
+
+    void lineGridWrapMatchesTextLayout() {
+        PageView pv;
+        ScriptEditor* editor = pv.editor();
+        useLineGridFont(editor);
+
+        const QVector<ScriptGenerator::Line> script = {
+            {ScriptEditor::SceneHeading, "INT. WAREHOUSE LOADING DOCK - NIGHT (RAIN, 1987)"},
+            {ScriptEditor::Action, QString("Crates stacked to the rafters, forklifts idle, a single bulb swinging. ").repeated(4)},
+            {ScriptEditor::CharacterName, "MARGARET O'CONNELL-WHITFIELD"},
+            {ScriptEditor::Parenthetical, "(under her breath, not looking at him at all)"},
+            {ScriptEditor::Dialogue, QString("You said the shipment would be here by midnight and it is well past that now. ").repeated(3)},
+            {ScriptEditor::Dialogue, "Supercalifragilisticexpialidociouslyunbreakablewordthatmustwrapsomewhere"},
+            {ScriptEditor::Transition, "SMASH CUT TO:"},
+            {ScriptEditor::Action, "A well-known, self-evident, hyphen-separated run-on state-of-the-art set-piece line."},
+        };
+        ScriptGenerator::populate(editor, script);
+        QCoreApplication::processEvents();
+
+        const qreal dpi = QGuiApplication::primaryScreen()->logicalDotsPerInchX();
+        const qreal advance = QFontMetricsF(editor->font(), editor).horizontalAdvance(QLatin1Char('M'));
+        const LineGridPaginator paginator;
+
+        int index = 0;
+        for (QTextBlock b = editor->document()->begin(); b.isValid(); b = b.next(), ++index) {
+            QTextLayout* layout = b.layout();
+            QVERIFY(layout && layout->lineCount() > 0);
+
+            // The editor lays each element out at the column width the grid assumes
+            const int type = b.userState();
+            const qreal widthPx = LineGridPaginator::elementGeometry(type).widthInches * dpi;
+            QVERIFY2(std::abs(layout->lineAt(0).width() - widthPx) <= 1.0,
+                     QString("Block %1: line width %2px, element geometry %3px")
+                         .arg(index).arg(layout->lineAt(0).width()).arg(widthPx).toUtf8().constData());
+            const int columns = static_cast<int>(std::floor(layout->lineAt(0).width() / advance));
+            QCOMPARE(columns, paginator.columnsForElement(type));
+
+            const int gridLines = paginator.blockLineCount(type, b.text());
+            QVERIFY2(gridLines == layout->lineCount(),
+                     QString("Block %1: line grid wrapped to %2 lines at %3 columns, QTextLayout to %4")
+                         .arg(index).arg(gridLines).arg(columns).arg(layout->lineCount())
+                         .toUtf8().constData());
+        }
+    }
+
+    void lineGridPaginationMatchesLayoutPagination() {
+        PageView pv;
+        ScriptEditor* editor = pv.editor();
+        useLineGridFont(editor);
+        ScriptGenerator::populate(editor, ScriptGenerator::generate(12));
+        QCoreApplication::processEvents();
+        QTextDocument* doc = editor->document();
+
+        // A layout page of exactly 54 lines of the editor font, with element spacing in
+        // whole lines, is the page the grid models
+        const int lineHeight = static_cast<int>(std::ceil(doc->firstBlock().layout()->lineAt(0).height()));
+        QVERIFY(lineHeight > 0);
+        for (QTextBlock b = doc->begin(); b.isValid(); b = b.next()) {
+            const int spaceBefore = qRound(b.blockFormat().topMargin());
+            QCOMPARE(spaceBefore, LineGridPaginator::elementGeometry(b.userState()).spaceBeforeLines * lineHeight);
+        }
+        const LineGridPaginator::Settings settings;
+        PaginationModel layoutPages;
+        layoutPages.setPageMetrics(settings.linesPerPage * lineHeight + 96, 24, settings.linesPerPage * lineHeight);
+        layoutPages.invalidate(doc->blockCount());
+        layoutPages.update(doc);
+
+        const LineGridPaginator::Result grid = LineGridPaginator(settings).paginate(doc);
+        QVERIFY2(grid.pageCount >= 10, "Expected a long multi-page script");
+        QCOMPARE(grid.pageCount, layoutPages.pageCount());
+
+        QVector<int> layoutFirstBlocks;
+        for (const PaginationModel::PageBreak &pageBreak : layoutPages.pageBreaks()) {
+            layoutFirstBlocks.append(pageBreak.blockNumber);
+        }
+        QCOMPARE(grid.pageFirstBlocks, layoutFirstBlocks);
+
+        const QVector<PaginationModel::ContinuationMarker> &markers = layoutPages.continuationMarkers();
+        QCOMPARE(grid.continuationMarkers.size(), markers.size());
+        for (int i = 0; i < markers.size(); ++i) {
+            QCOMPARE(grid.continuationMarkers.at(i).pageIndex, markers.at(i).pageIndex);
+            QCOMPARE(grid.continuationMarkers.at(i).isTop, markers.at(i).isTop);
+            QCOMPARE(grid.continuationMarkers.at(i).text, markers.at(i).text);
+        }
+    }
+
+    void lineGridPaginatesOnSixLinesPerInch() {
+        LineGridPaginator paginator;
+        QCOMPARE(paginator.columnsForElement(ScriptEditor::Action), 60);
+        QCOMPARE(paginator.columnsForElement(ScriptEditor::Dialogue), 35);
+
+        // Dialogue has no space before: 54 one-line blocks fill exactly one page
+        QVector<LineGridPaginator::Block> blocks;
+        for (int i = 0; i < 54; ++i) {
+            blocks.append(LineGridPaginator::Block{ScriptEditor::Dialogue, QString("Line %1").arg(i)});
+        }
+        LineGridPaginator::Result result = paginator.paginate(blocks);
+        QCOMPARE(result.pageCount, 1);
+        QVERIFY(result.continuationMarkers.isEmpty());
+
+        blocks.append(LineGridPaginator::Block{ScriptEditor::Dialogue, "One more"});
+        result = paginator.paginate(blocks);
+        QCOMPARE(result.pageCount, 2);
+        QCOMPARE(result.pageFirstBlocks, QVector<int>{54});
+        QCOMPARE(result.continuationMarkers.size(), 2);
+        QCOMPARE(result.continuationMarkers.at(0).pageIndex, 0);
+        QCOMPARE(result.continuationMarkers.at(0).text, QString("(MORE)"));
+        QCOMPARE(result.continuationMarkers.at(1).pageIndex, 1);
+        QCOMPARE(result.continuationMarkers.at(1).text, QString("(CONT'D)"));
+
+        // Action takes a blank line before it: 27 fit, the 28th starts page 2
+        blocks.clear();
+        for (int i = 0; i < 28; ++i) {
+            blocks.append(LineGridPaginator::Block{ScriptEditor::Action, QString("Beat %1.").arg(i)});
+        }
+        result = paginator.paginate(blocks);
+        QCOMPARE(result.pageCount, 2);
+        QCOMPARE(result.pageFirstBlocks, QVector<int>{27});
+        QVERIFY(result.continuationMarkers.isEmpty());
     }
 
     void loadsFdxIntoExpectedElementTypes() {
@@ -2,6 +2,7 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QRegularExpression>
+#include <QStandardPaths>
 #include <QTemporaryDir>
 #include <QTextBlock>
 #include <QTest>
@@ -39,6 +40,12 @@ private:
     }
 
 private slots:
+    void initTestCase()
+    {
+        // Editors load the user dictionary; keep the real one out of these results
+        QStandardPaths::setTestModeEnabled(true);
+    }
+
     void exportedPdfPageCountMatchesViewPageCount()
     {
         QTemporaryDir tempDir;
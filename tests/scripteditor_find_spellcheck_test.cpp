@@ -1,8 +1,58 @@
+#include <QAtomicInt>
 #include <QCoreApplication>
+#include <QFile>
 #include <QObject>
+#include <QRegularExpression>
+#include <QScopeGuard>
+#include <QSemaphore>
+#include <QStandardPaths>
+#include <QStringList>
 #include <QTest>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTemporaryDir>
+#include <QTextDocument>
 
+#include "basedictionary.h"
+#include "editdistance.h"
+#include "highlightlayer.h"
 #include "scripteditor.h"
+#include "spellcheckservice.h"
+#include "suggestionindex.h"
+#include "texttokenizer.h"
+#include "userdictionary.h"
+
+namespace {
+
+// Holds the first check of the old script's text on the worker until the test opens the gate
+class GatedSpellChecker : public AbstractSpellChecker {
+public:
+    GatedSpellChecker(QSemaphore *started, QSemaphore *gate) : m_started(started), m_gate(gate) {}
+
+    bool isAvailable() const override { return true; }
+    QList<Misspelling> checkText(const QString &text) const override
+    {
+        if (text.contains(QLatin1String("sentnce")) && m_gatedChecks.fetchAndAddOrdered(1) == 0) {
+            m_started->release();
+            m_gate->acquire();
+        }
+        return m_checker.checkText(text);
+    }
+    QStringList suggestionsFor(const QString &word) const override { return m_checker.suggestionsFor(word); }
+    void addWord(const QString &word) override { m_checker.addWord(word); }
+    bool supportsBackgroundChecks() const override { return true; }
+
+    // Blocks of the old text checked; a cancelled pass stops after the one it was held in
+    int gatedChecks() const { return m_gatedChecks.loadAcquire(); }
+
+private:
+    BasicSpellChecker m_checker;
+    QSemaphore *m_started;
+    QSemaphore *m_gate;
+    mutable QAtomicInt m_gatedChecks;
+};
+
+} // namespace
 
 class ScriptEditorFindSpellcheckTests : public QObject {
     Q_OBJECT
@@ -26,6 +76,18 @@ private:
     }
 
 private slots:
+    void initTestCase()
+    {
+        // Editors save added words; keep them away from the real user dictionary
+        QStandardPaths::setTestModeEnabled(true);
+        QFile::remove(UserDictionary::defaultPath());
+    }
+
+    void cleanupTestCase()
+    {
+        QFile::remove(UserDictionary::defaultPath());
+    }
+
     void findCountsMatchesCaseInsensitiveByDefault()
     {
         ScriptEditor editor;
@@ -78,6 +140,111 @@ private slots:
         QCOMPARE(editor.activeFindMatchIndex(), 1);
     }
 
+    void findMatchesFollowEditsWithoutMovingCursor()
+    {
+        ScriptEditor editor;
+        focusEditor(&editor);
+
+        editor.setPlainText("The door opens.\nA second door.\nNo match here.\ndoor door");
+        editor.setFindQuery("door");
+        QCOMPARE(editor.findMatchCount(), 4);
+
+        auto rescannedCount = [&editor] {
+            editor.setFindQuery(QString());
+            editor.setFindQuery("door");
+            return editor.findMatchCount();
+        };
+
+        QTextCursor cursor(editor.document());
+        cursor.movePosition(QTextCursor::End);
+        editor.setTextCursor(cursor);
+
+        // Create a match, split a block, merge blocks and break a match apart
+        cursor.insertText(" door");
+        QCOMPARE(editor.findMatchCount(), 5);
+        QCOMPARE(editor.textCursor().position(), editor.document()->characterCount() - 1);
+
+        QTextBlock block = editor.document()->findBlockByNumber(1);
+        cursor.setPosition(block.position() + 2);
+        cursor.insertBlock();
+        QCOMPARE(editor.findMatchCount(), 5);
+
+        cursor.setPosition(editor.document()->findBlockByNumber(2).position() - 1);
+        cursor.deleteChar();
+        QCOMPARE(editor.findMatchCount(), 5);
+
+        cursor.setPosition(6);
+        cursor.insertText("x");
+        QCOMPARE(editor.findMatchCount(), 4);
+
+        const int incrementalCount = editor.findMatchCount();
+        QCOMPARE(rescannedCount(), incrementalCount);
+
+        // Whole-word matches appear and disappear as neighbours change
+        editor.setFindOptions(false, true);
+        const int wholeWordCount = editor.findMatchCount();
+        cursor.movePosition(QTextCursor::End);
+        cursor.insertText("s");
+        QCOMPARE(editor.findMatchCount(), wholeWordCount - 1);
+        cursor.deletePreviousChar();
+        QCOMPARE(editor.findMatchCount(), wholeWordCount);
+    }
+
+    void highlightLayerSelectsOnlyRequestedSpan()
+    {
+        QTextDocument doc;
+        doc.setPlainText("one two three four five six seven eight");
+
+        HighlightLayer layer;
+        QVector<HighlightLayer::Range> ranges;
+        for (int start = 0; start < 36; start += 4) {
+            ranges.append({start, 3});
+        }
+        layer.setRanges(HighlightLayer::FindMatch, ranges, 2);
+
+        QVector<QAbstractTextDocumentLayout::Selection> selections;
+        layer.appendSelections(&doc, 10, 16, selections);
+        QCOMPARE(selections.size(), 2);
+        QCOMPARE(selections.at(0).cursor.selectionStart(), 8);
+        QCOMPARE(selections.at(1).cursor.selectionStart(), 12);
+
+        // Deleting 4 characters inside [4, 12) drops the ranges starting there and shifts the rest
+        const int insertIndex = HighlightLayer::removeEditedRanges(ranges, 4, 12, -4);
+        QCOMPARE(insertIndex, 1);
+        QCOMPARE(ranges.size(), 7);
+        QCOMPARE(ranges.at(1).start, 8);
+    }
+
+    void editsUpdateHighlightRangesInPlace()
+    {
+        ScriptEditor editor;
+        focusEditor(&editor);
+
+        editor.setSpellcheckEnabled(true);
+        QStringList lines;
+        for (int i = 0; i < 2000; ++i) {
+            lines << "the needle in a haystak";
+        }
+        editor.setPlainText(lines.join('\n'));
+        waitForSpellcheck();
+        editor.setFindQuery("needle");
+        QCOMPARE(editor.findMatchCount(), 2000);
+        QVERIFY(editor.spellcheckMisspellingCount() > 0);
+
+        const HighlightLayer &layer = editor.highlightLayer();
+        const HighlightLayer::Range *matches = layer.ranges(HighlightLayer::FindMatch).constData();
+        const HighlightLayer::Range *misspellings = layer.ranges(HighlightLayer::Spelling).constData();
+
+        // An edit mid-script shifts the lists' tails; a shared copy would detach both first
+        QTextCursor cursor(editor.document()->findBlockByNumber(1000));
+        cursor.movePosition(QTextCursor::EndOfBlock);
+        cursor.insertText("x");
+
+        QCOMPARE(editor.findMatchCount(), 2000);
+        QCOMPARE(layer.ranges(HighlightLayer::FindMatch).constData(), matches);
+        QCOMPARE(layer.ranges(HighlightLayer::Spelling).constData(), misspellings);
+    }
+
     void spellcheckDetectsMisspellingsAndCanBeDisabled()
     {
         ScriptEditor editor;
@@ -95,6 +262,242 @@ private slots:
         QCOMPARE(editor.spellcheckMisspellingCount(), 0);
     }
 
+    void spellcheckRechecksOnlyEditedBlocks()
+    {
+        ScriptEditor editor;
+        focusEditor(&editor);
+
+        editor.setSpellcheckEnabled(true);
+        editor.setPlainText("the sentnce\nthe story\nthe erors");
+        waitForSpellcheck();
+        QCOMPARE(editor.spellcheckMisspellingCount(), 2);
+
+        // Misspellings outside the edited block keep their place while it is rechecked
+        QTextCursor cursor(editor.document()->findBlockByNumber(1));
+        cursor.movePosition(QTextCursor::EndOfBlock);
+        cursor.insertText(" agian");
+        waitForSpellcheck();
+        QCOMPARE(editor.spellcheckMisspellingCount(), 3);
+
+        cursor.movePosition(QTextCursor::StartOfBlock, QTextCursor::KeepAnchor);
+        cursor.removeSelectedText();
+        waitForSpellcheck();
+        QCOMPARE(editor.spellcheckMisspellingCount(), 2);
+
+        editor.setSpellcheckEnabled(false);
+        QCOMPARE(editor.spellcheckMisspellingCount(), 0);
+        editor.setSpellcheckEnabled(true);
+        waitForSpellcheck();
+        QCOMPARE(editor.spellcheckMisspellingCount(), 2);
+    }
+
+    void spellcheckDiscardsSupersededBackgroundResults()
+    {
+        QSemaphore started;
+        QSemaphore gate;
+        ScriptEditor editor;
+        auto *checker = new GatedSpellChecker(&started, &gate);
+        editor.setSpellChecker(std::unique_ptr<AbstractSpellChecker>(checker));
+        // Runs before the editor's destructor, which waits for the worker
+        const auto releaseWorker = qScopeGuard([&gate] { gate.release(1 << 20); });
+        focusEditor(&editor);
+
+        editor.setSpellcheckEnabled(true);
+        QStringList lines;
+        for (int i = 0; i < 4000; ++i) {
+            lines << "the sentnce has erors";
+        }
+        editor.setPlainText(lines.join('\n'));
+
+        // Replace the text while the worker is held inside the pass's first block
+        QTRY_VERIFY(started.available() > 0);
+        editor.setPlainText("the story has erors");
+        gate.release(1 << 20);
+
+        // The pool runs one job at a time, so the superseded pass has returned and posted
+        // whatever it was going to before the new pass delivers. A stale chunk would leave
+        // ranges past the end of the new text, which the new pass never clears.
+        QTRY_COMPARE(editor.spellcheckMisspellingCount(), 1);
+        QCOMPARE(checker->gatedChecks(), 1);
+        QCoreApplication::processEvents();
+        QCOMPARE(editor.spellcheckMisspellingCount(), 1);
+    }
+
+    void addingWordClearsOnlyItsOccurrences()
+    {
+        ScriptEditor editor;
+        focusEditor(&editor);
+
+        editor.setSpellcheckEnabled(true);
+        editor.setPlainText("the sentnce\nthe Zorblat story\nthe erors of zorblat");
+        waitForSpellcheck();
+        QCOMPARE(editor.spellcheckMisspellingCount(), 4);
+
+        editor.addWordToDictionary("Zorblat");
+        QCOMPARE(editor.spellcheckMisspellingCount(), 2);
+
+        // Blocks edited afterwards are checked against the grown dictionary
+        QTextCursor cursor(editor.document()->lastBlock());
+        cursor.movePosition(QTextCursor::EndOfBlock);
+        cursor.insertText(" zorblat");
+        waitForSpellcheck();
+        QCOMPARE(editor.spellcheckMisspellingCount(), 2);
+
+        editor.setSpellcheckEnabled(false);
+        editor.setSpellcheckEnabled(true);
+        waitForSpellcheck();
+        QCOMPARE(editor.spellcheckMisspellingCount(), 2);
+    }
+
+    void userDictionaryPersistsAddedWords()
+    {
+        QTemporaryDir dir;
+        const QString path = dir.filePath("words/user_dictionary.txt");
+        {
+            BasicSpellChecker checker(path);
+            QCOMPARE(checker.checkText("the zorblat").size(), 1);
+            checker.addWord("Zorblat");
+            checker.addWord("zorblat");
+            checker.addWord("Quexil");
+        }
+
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+        QCOMPARE(file.readAll(), QByteArray("zorblat\nquexil\n"));
+        file.close();
+
+        BasicSpellChecker reloaded(path);
+        QVERIFY(reloaded.checkText("the zorblat and quexil").isEmpty());
+        QVERIFY(reloaded.suggestionsFor("zorblt").contains("zorblat"));
+
+        UserDictionary inMemory;
+        QVERIFY(inMemory.add("zorblat"));
+        QVERIFY(!inMemory.add("zorblat"));
+        QVERIFY(inMemory.add("abbot"));
+        QVERIFY(inMemory.contains(u"zorblat"));
+        // Lookups take views into the tokenized text
+        const QString line = QStringLiteral("the abbot met zorblat");
+        QVERIFY(inMemory.contains(QStringView(line).mid(4, 5)));
+        QVERIFY(inMemory.contains(QStringView(line).mid(14)));
+        QVERIFY(!inMemory.contains(QStringView(line).mid(14, 6)));
+        QCOMPARE(inMemory.words(), QStringList({"abbot", "zorblat"}));
+    }
+
+    void tokenizerMatchesRegularExpressions()
+    {
+        static const QRegularExpression wordRegex("[A-Za-z][A-Za-z']*");
+        static const QRegularExpression whitespace("\\s+");
+        const QStringList samples = {
+            "",
+            "INT. DINER - NIGHT",
+            "  She doesn't\tknow what's   'next'...\n",
+            "Caf\u00e9 au lait\u00a0\u3000with\u2003fr\u00e8res and o'clock-ish 1920s",
+            "a'b ''' 'x lengthywordsthatcrossseverallanes,andpunctuation;betweenthem!!",
+        };
+        for (const QString &sample : samples) {
+            QVector<int> expected;
+            QRegularExpressionMatchIterator it = wordRegex.globalMatch(sample);
+            while (it.hasNext()) {
+                const QRegularExpressionMatch match = it.next();
+                expected << match.capturedStart(0) << match.capturedLength(0);
+            }
+            QVector<int> tokens;
+            TextTokenizer::SpellingWords words(sample);
+            TextTokenizer::Token token;
+            while (words.next(token)) {
+                tokens << token.start << token.length;
+            }
+            QCOMPARE(tokens, expected);
+            QCOMPARE(TextTokenizer::countWords(sample), int(sample.split(whitespace, Qt::SkipEmptyParts).size()));
+        }
+
+        QVERIFY(TextTokenizer::isWholeWord(u"he said", 0, 2));
+        QVERIFY(!TextTokenizer::isWholeWord(u"the", 1, 2));
+        QVERIFY(!TextTokenizer::isWholeWord(u"he2", 0, 2));
+        QVERIFY(TextTokenizer::isWholeWord(u"(he)", 1, 2));
+        QVERIFY(!TextTokenizer::isWholeWord(u"\u00e9he", 1, 2));
+    }
+
+    void checkerDetectsFirstAndSuggestsOnDemand()
+    {
+        BasicSpellChecker checker;
+        const QList<Misspelling> misspellings = checker.checkText("I know the wrld is here");
+        QCOMPARE(misspellings.size(), 1);
+        QCOMPARE(misspellings.first().word, QString("wrld"));
+
+        const QStringList suggestions = checker.suggestionsFor(misspellings.first().word);
+        QVERIFY(suggestions.contains("would"));
+        QCOMPARE(checker.suggestionsFor("WRLD"), suggestions);
+    }
+
+    void baseDictionaryTableHoldsEveryBuiltInWord()
+    {
+        for (const QString &word : {"scene", "screenplay", "int", "ext", "fade", "dissolve", "exterior", "a"}) {
+            QVERIFY2(BaseDictionary::contains(word), qPrintable(word));
+        }
+        for (const QString &word : {"scen", "scenes", "INT", "wrld", ""}) {
+            QVERIFY2(!BaseDictionary::contains(word), qPrintable(word));
+        }
+        const QStringList words = BaseDictionary::words();
+        QCOMPARE(words.size(), BaseDictionary::size());
+        QVERIFY(words.contains("continuously"));
+
+        BasicSpellChecker checker;
+        checker.addWord("Slugline");
+        QCOMPARE(checker.checkText("The slugline fades").size(), 1);
+        QVERIFY(checker.suggestionsFor("sluglin").contains("slugline"));
+    }
+
+    void suggestionIndexFindsWordsWithinTwoEdits()
+    {
+        SuggestionIndex index;
+        index.build({"door", "doors", "floor", "dorm", "odor", "detective", "detectives", "window"});
+
+        QCOMPARE(index.suggestions("dor", 6), QStringList({"door", "dorm", "odor", "doors"}));
+        QCOMPARE(index.suggestions("detectiev", 6), QStringList({"detective", "detectives"}));
+        QVERIFY(index.suggestions("zzzz", 6).isEmpty());
+
+        index.addWord("dory");
+        QVERIFY(index.contains("dory"));
+        QCOMPARE(index.suggestions("dor", 2), QStringList({"door", "dorm"}));
+        QVERIFY(index.suggestions("dor", 6).contains("dory"));
+        QCOMPARE(index.wordCount(), 9);
+    }
+
+    void editDistanceKernelsMatchDynamicProgramming()
+    {
+        QCOMPARE(EditDistance::bitParallel(u"kitten", u"sitting"), 3);
+        QCOMPARE(EditDistance::bitParallel(u"", u"door"), 4);
+        QCOMPARE(EditDistance::bitParallel(u"caf\u00e9", u"cafe"), 1);
+        QCOMPARE(EditDistance::bounded(u"detective", u"defective", 2), 1);
+        QCOMPARE(EditDistance::bounded(u"detective", u"defensive", 2), 3);
+
+        // Random words over a small alphabet, up to and past the 64-unit kernel limit
+        quint32 state = 2463534242u;
+        auto next = [&state] {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+        };
+        auto randomWord = [&next](int maxLength) {
+            QString word;
+            const int length = static_cast<int>(next() % static_cast<quint32>(maxLength + 1));
+            for (int i = 0; i < length; ++i) {
+                word.append(QChar(u"abc\u00e9"[next() % 4]));
+            }
+            return word;
+        };
+        for (int i = 0; i < 2000; ++i) {
+            const int maxLength = i % 2 ? 10 : 70;
+            const QString a = randomWord(maxLength);
+            const QString b = randomWord(maxLength);
+            const int expected = EditDistance::levenshtein(a, b);
+            QCOMPARE(EditDistance::bitParallel(a, b), expected);
+            QCOMPARE(EditDistance::bounded(a, b, 2), qMin(expected, 3));
+        }
+    }
+
     void spellcheckProvidesSuggestionsForCommonTypos()
     {
         ScriptEditor editor;
@@ -1,6 +1,9 @@
 #include <QTest>
 #include <QObject>
 #include <QCoreApplication>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTextDocument>
 #include <QTextCursor>
 #include <QTextBlock>
 #include "scripteditor.h"
@@ -20,6 +23,11 @@ private:
     }
 
 private slots:
+    void initTestCase() {
+        // Editors load the user dictionary; keep the real one out of these results
+        QStandardPaths::setTestModeEnabled(true);
+    }
+
     void formatChangePreservesTextWithContent() {
         ScriptEditor editor;
         focusEditor(&editor);
@@ -139,6 +147,26 @@ private slots:
         QTest::keyClick(&editor, Qt::Key_A);
         QCOMPARE(editor.textCursor().block().userState(), static_cast<int>(ScriptEditor::SceneHeading));
     }
+
+    void formatDocumentOnlyTouchesBlocksThatDiffer() {
+        ScriptEditor editor;
+        focusEditor(&editor);
+
+        QTest::keyClicks(&editor, "int. house");
+        QTest::keyClick(&editor, Qt::Key_Return);
+        QTest::keyClicks(&editor, "Rain falls.");
+
+        QSignalSpy changes(editor.document(), &QTextDocument::contentsChange);
+        editor.formatDocument();
+        QCOMPARE(changes.count(), 0);
+
+        QTextBlock heading = editor.document()->firstBlock();
+        heading.setUserState(static_cast<int>(ScriptEditor::Transition));
+        editor.formatDocument();
+        QCOMPARE(changes.count(), 1);
+        QCOMPARE(changes.first().at(0).toInt(), 0);
+        QCOMPARE(editor.document()->firstBlock().blockFormat().alignment(), Qt::AlignRight);
+    }
 };
 
 QTEST_MAIN(ScriptEditorFormatTests)
@@ -3,9 +3,53 @@
 #include <QCoreApplication>
 #include <QClipboard>
 #include <QGuiApplication>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTextDocument>
 #include <QTextCursor>
 #include <QTextBlock>
 #include "scripteditor.h"
+#include "undohistory.h"
+
+namespace {
+
+class CountingCommand : public SizedUndoCommand {
+public:
+    CountingCommand(int *value, qsizetype cost) : m_value(value), m_cost(cost) {}
+    void redo() override { ++*m_value; }
+    void undo() override { --*m_value; }
+    qsizetype memoryCost() const override { return m_cost; }
+
+private:
+    int *m_value;
+    qsizetype m_cost;
+};
+
+// Commands of one group merge, like the characters of a typed word
+class GroupCommand : public SizedUndoCommand {
+public:
+    GroupCommand(int *value, int group) : m_value(value), m_group(group) {}
+    int id() const override { return 1; }
+    bool mergeWith(const QUndoCommand *other) override
+    {
+        const auto *command = static_cast<const GroupCommand *>(other);
+        if (command->m_group != m_group) {
+            return false;
+        }
+        m_steps += command->m_steps;
+        return true;
+    }
+    void redo() override { *m_value += m_steps; }
+    void undo() override { *m_value -= m_steps; }
+    qsizetype memoryCost() const override { return sizeof(*this); }
+
+private:
+    int *m_value;
+    int m_group;
+    int m_steps = 1;
+};
+
+} // namespace
 
 class ScriptEditorUndoTests : public QObject {
     Q_OBJECT
@@ -22,6 +66,11 @@ private:
     }
 
 private slots:
+    void initTestCase() {
+        // Editors load the user dictionary; keep the real one out of these results
+        QStandardPaths::setTestModeEnabled(true);
+    }
+
     void undoPerWordWhitespaceAndPunctuation() {
         ScriptEditor editor;
         focusEditor(&editor);
@@ -52,6 +101,221 @@ private slots:
         QVERIFY(editor.toPlainText().trimmed().isEmpty());
     }
 
+    void replaceAllIsOneEditAndOneUndoStep() {
+        ScriptEditor editor;
+        focusEditor(&editor);
+
+        editor.setPlainText("BOB enters.\nBOB\nHi, Bob. Bobby waves.");
+        editor.setFindOptions(false, true);
+        editor.setFindQuery("bob");
+        QCOMPARE(editor.findMatchCount(), 3);
+
+        QSignalSpy changes(editor.document(), &QTextDocument::contentsChange);
+        QCOMPARE(editor.replaceAll("Alexander"), 3);
+        QCOMPARE(changes.count(), 1);
+        QCOMPARE(editor.toPlainText(), QString("Alexander enters.\nAlexander\nHi, Alexander. Bobby waves."));
+
+        changes.clear();
+        editor.undo();
+        QCOMPARE(changes.count(), 1);
+        QCOMPARE(editor.toPlainText(), QString("BOB enters.\nBOB\nHi, Bob. Bobby waves."));
+
+        editor.redo();
+        QCOMPARE(editor.toPlainText(), QString("Alexander enters.\nAlexander\nHi, Alexander. Bobby waves."));
+    }
+
+    void compoundUndoPublishesOneChange() {
+        ScriptEditor editor;
+        focusEditor(&editor);
+
+        editor.setPlainText("BOB enters.\nBOB\nHi, Bob. Bobby waves.");
+        editor.setFindOptions(false, true);
+        editor.setFindQuery("bob");
+        QCOMPARE(editor.replaceAll("Alexander"), 3);
+
+        // Undoing the replace all rewrites three spans but announces one change
+        QSignalSpy cursorMoves(&editor, &QTextEdit::cursorPositionChanged);
+        QSignalSpy elements(&editor, &ScriptEditor::elementChanged);
+        QSignalSpy commits(&editor, &ScriptEditor::editCommitted);
+        editor.undo();
+        QCOMPARE(cursorMoves.count(), 1);
+        QCOMPARE(elements.count(), 1);
+        QCOMPARE(commits.count(), 1);
+
+        const auto record = commits.first().first().value<ScriptEditor::EditRecord>();
+        QCOMPARE(record.start, 0);
+        QVERIFY(record.end >= QString("BOB enters.\nBOB\nHi, Bob").size());
+        QCOMPARE(record.cursorPosition, editor.textCursor().position());
+
+        // Nested transactions commit once, when the outermost ends
+        commits.clear();
+        {
+            ScriptEditor::EditTransaction outer(&editor);
+            {
+                ScriptEditor::EditTransaction inner(&editor);
+                QTextCursor cursor(editor.document());
+                cursor.insertText("A");
+            }
+            QCOMPARE(commits.count(), 0);
+        }
+        QCOMPARE(commits.count(), 1);
+        QCOMPARE(commits.first().first().value<ScriptEditor::EditRecord>().start, 0);
+    }
+
+    void transactionReportsSelectionChanges() {
+        ScriptEditor editor;
+        focusEditor(&editor);
+        editor.setPlainText("BOB enters.");
+
+        QTextCursor selected(editor.document());
+        selected.movePosition(QTextCursor::EndOfWord, QTextCursor::KeepAnchor);
+        editor.setTextCursor(selected);
+        QVERIFY(editor.textCursor().hasSelection());
+
+        // Collapsing the selection inside a transaction still reaches selection listeners
+        QSignalSpy selections(&editor, &QTextEdit::selectionChanged);
+        QSignalSpy copyAvailable(&editor, &QTextEdit::copyAvailable);
+        {
+            ScriptEditor::EditTransaction transaction(&editor);
+            QTextCursor collapsed(editor.document());
+            collapsed.movePosition(QTextCursor::End);
+            editor.placeCursor(collapsed);
+        }
+        QVERIFY(!editor.textCursor().hasSelection());
+        QCOMPARE(selections.count(), 1);
+        QCOMPARE(copyAvailable.count(), 1);
+        QCOMPARE(copyAvailable.first().first().toBool(), false);
+
+        // A transaction that leaves the selection alone announces nothing about it
+        selections.clear();
+        copyAvailable.clear();
+        {
+            ScriptEditor::EditTransaction transaction(&editor);
+        }
+        QCOMPARE(selections.count(), 0);
+        QCOMPARE(copyAvailable.count(), 0);
+    }
+
+    void undoHistoryCompactsToCheckpointsWithinBudget() {
+        int value = 0;
+        UndoHistory history;
+        history.setCheckpointCapture([&value] { return QByteArray::number(value); });
+        history.setMemoryBudget(30000);
+
+        for (int i = 0; i < 450; ++i) {
+            history.push(new CountingCommand(&value, 100));
+        }
+        QCOMPARE(value, 450);
+        QVERIFY(history.memoryUsage() <= history.memoryBudget());
+
+        // Commands before the checkpoint at 200 were folded into it
+        QCOMPARE(history.count(), 250);
+        QCOMPARE(history.checkpointCount(), 2);
+        while (history.canUndo()) {
+            history.undo();
+        }
+        QCOMPARE(value, 200);
+        while (history.canRedo()) {
+            history.redo();
+        }
+        QCOMPARE(value, 450);
+    }
+
+    void mergingCommandsNeverCaptureCheckpoints() {
+        int value = 0;
+        int captures = 0;
+        UndoHistory history;
+        history.setCheckpointCapture([&value, &captures] {
+            ++captures;
+            return QByteArray::number(value);
+        });
+
+        for (int group = 0; group < UndoHistory::kCheckpointInterval; ++group) {
+            history.push(new GroupCommand(&value, group));
+        }
+        QCOMPARE(captures, 1);
+
+        // A checkpoint is due, but typing into the top command leaves it for the next command
+        for (int i = 0; i < 100; ++i) {
+            history.push(new GroupCommand(&value, UndoHistory::kCheckpointInterval - 1));
+        }
+        QCOMPARE(captures, 1);
+        QCOMPARE(history.count(), UndoHistory::kCheckpointInterval);
+
+        history.push(new GroupCommand(&value, UndoHistory::kCheckpointInterval));
+        QCOMPARE(captures, 2);
+        QCOMPARE(history.historyPoints().last().index, UndoHistory::kCheckpointInterval);
+        for (int i = 0; i < 100; ++i) {
+            history.push(new GroupCommand(&value, UndoHistory::kCheckpointInterval));
+        }
+        QCOMPARE(captures, 2);
+        QCOMPARE(history.checkpointCount(), 2);
+        QCOMPARE(value, UndoHistory::kCheckpointInterval + 201);
+    }
+
+    void restoreToLoadsNearestCheckpoint() {
+        int value = 0;
+        int restores = 0;
+        UndoHistory history;
+        history.setCheckpointCapture([&value] { return QByteArray::number(value); });
+        history.setCheckpointRestore([&value, &restores](const QByteArray &snapshot) {
+            value = snapshot.toInt();
+            ++restores;
+        });
+
+        for (int i = 0; i < 450; ++i) {
+            history.push(new CountingCommand(&value, 100));
+        }
+        QCOMPARE(history.historyPoints().size(), 3);
+        QCOMPARE(history.historyPoints().first().index, 0);
+
+        // Loads the checkpoint at 200 and replays ten commands instead of undoing 240
+        QVERIFY(history.restoreTo(210));
+        QCOMPARE(value, 210);
+        QCOMPARE(restores, 1);
+        QVERIFY(history.canRedo());
+
+        // Close by, stepping beats loading a checkpoint
+        QVERIFY(history.restoreTo(205));
+        QCOMPARE(value, 205);
+        QCOMPARE(restores, 1);
+
+        QVERIFY(history.restoreTo(0));
+        QCOMPARE(value, 0);
+        QVERIFY(!history.canUndo());
+        QVERIFY(!history.restoreTo(451));
+
+        while (history.canRedo()) {
+            history.redo();
+        }
+        QCOMPARE(value, 450);
+    }
+
+    void restoreHistoryPointRebuildsDocument() {
+        ScriptEditor editor;
+        focusEditor(&editor);
+
+        QTest::keyClicks(&editor, "int. house");
+        QTest::keyClick(&editor, Qt::Key_Return);
+        QTest::keyClicks(&editor, "Rain falls.");
+        const QString finalText = editor.toPlainText();
+        const int finalElement = editor.document()->lastBlock().userState();
+        QVERIFY(!editor.historyPoints().isEmpty());
+
+        QSignalSpy commits(&editor, &ScriptEditor::editCommitted);
+        QSignalSpy redoAvailable(&editor, &ScriptEditor::redoAvailableChanged);
+        QVERIFY(editor.restoreHistoryPoint(0));
+        QCOMPARE(commits.count(), 1);
+        QVERIFY(editor.toPlainText().trimmed().isEmpty());
+        QCOMPARE(redoAvailable.last().at(0).toBool(), true);
+
+        while (!redoAvailable.isEmpty() && redoAvailable.last().at(0).toBool()) {
+            editor.redo();
+        }
+        QCOMPARE(editor.toPlainText(), finalText);
+        QCOMPARE(editor.document()->lastBlock().userState(), finalElement);
+    }
+
     void undoPasteIsSingleStep() {
         ScriptEditor editor;
         focusEditor(&editor);
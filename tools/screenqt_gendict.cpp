@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "fnv1a.h"
+
+// Generates the constexpr perfect-hash table behind BaseDictionary:
+//   screenqt_gendict <base_dictionary.txt> <basedictionary_table.h>
+//
+// Hash and displace: words are grouped into buckets by one hash, then, largest bucket
+// first, each bucket gets the smallest basis that sends all of its words to free slots.
+//
+// Plain C++ on purpose: the tool runs at build time, where Qt's runtime may not be on
+// PATH (Windows) or runnable at all (cross builds).
+namespace {
+
+constexpr std::uint32_t kBucketBasis = 2166136261u;
+
+std::uint32_t wordHash(const std::string &word, std::uint32_t basis)
+{
+    return Fnv1a::hash(word.data(), word.size(), basis);
+}
+
+bool placeWords(const std::vector<std::string> &words, std::vector<std::uint32_t> &displacements,
+                std::vector<int> &slots)
+{
+    const std::size_t bucketCount = displacements.size();
+    std::vector<std::vector<int>> buckets(bucketCount);
+    for (std::size_t i = 0; i < words.size(); ++i) {
+        buckets[wordHash(words[i], kBucketBasis) % bucketCount].push_back(static_cast<int>(i));
+    }
+
+    std::vector<std::size_t> order(bucketCount);
+    for (std::size_t b = 0; b < bucketCount; ++b) {
+        order[b] = b;
+    }
+    std::stable_sort(order.begin(), order.end(), [&buckets](std::size_t a, std::size_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    std::fill(slots.begin(), slots.end(), -1);
+    for (std::size_t b : order) {
+        const std::vector<int> &bucket = buckets[b];
+        if (bucket.empty()) {
+            displacements[b] = 1;
+            continue;
+        }
+        bool placed = false;
+        for (std::uint32_t basis = 1; basis < 1000000 && !placed; ++basis) {
+            std::vector<std::size_t> chosen;
+            for (int word : bucket) {
+                const std::size_t slot = wordHash(words[word], basis) % slots.size();
+                if (slots[slot] >= 0 || std::find(chosen.begin(), chosen.end(), slot) != chosen.end()) {
+                    break;
+                }
+                chosen.push_back(slot);
+            }
+            if (chosen.size() == bucket.size()) {
+                for (std::size_t i = 0; i < bucket.size(); ++i) {
+                    slots[chosen[i]] = bucket[i];
+                }
+                displacements[b] = basis;
+                placed = true;
+            }
+        }
+        if (!placed) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string trimmedLower(const std::string &line)
+{
+    const auto isSpace = [](char ch) { return std::isspace(static_cast<unsigned char>(ch)) != 0; };
+    const auto first = std::find_if_not(line.begin(), line.end(), isSpace);
+    const auto last = std::find_if_not(line.rbegin(), line.rend(), isSpace).base();
+    std::string result(first, first < last ? last : first);
+    for (char &ch : result) {
+        if (ch >= 'A' && ch <= 'Z') {
+            ch = static_cast<char>(ch - 'A' + 'a');
+        }
+    }
+    return result;
+}
+
+std::string fileName(const std::string &path)
+{
+    const std::size_t separator = path.find_last_of("/\\");
+    return separator == std::string::npos ? path : path.substr(separator + 1);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3) {
+        std::cerr << "usage: screenqt_gendict <base_dictionary.txt> <basedictionary_table.h>\n";
+        return 2;
+    }
+    const std::string inputPath = argv[1];
+    const std::string outputPath = argv[2];
+
+    std::ifstream input(inputPath);
+    if (!input) {
+        std::cerr << "Cannot read " << inputPath << '\n';
+        return 1;
+    }
+    std::vector<std::string> words;
+    std::string rawLine;
+    while (std::getline(input, rawLine)) {
+        const std::string line = trimmedLower(rawLine);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        // Slots are stored as Latin-1 string literals
+        for (char ch : line) {
+            if (static_cast<unsigned char>(ch) > 0x7f || ch == '"' || ch == '\\') {
+                std::cerr << "Unsupported character in " << line << '\n';
+                return 1;
+            }
+        }
+        words.push_back(line);
+    }
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+
+    std::vector<std::uint32_t> displacements(words.size() / 4 + 1);
+    std::vector<int> slots(words.size() + words.size() / 4 + 1);
+    if (!placeWords(words, displacements, slots)) {
+        std::cerr << "No perfect hash found for " << words.size() << " words\n";
+        return 1;
+    }
+
+    std::ostringstream out;
+    out << "// Generated by screenqt_gendict from " << fileName(inputPath) << ". Do not edit.\n"
+        << "#pragma once\n\n"
+        << "#include <array>\n"
+        << "#include <cstdint>\n\n"
+        << "namespace BaseDictionaryTable {\n\n"
+        << "constexpr int kWordCount = " << words.size() << ";\n"
+        << "constexpr std::uint32_t kBucketBasis = " << kBucketBasis << "u;\n\n"
+        << "constexpr std::array<std::uint32_t, " << displacements.size() << "> kDisplacements = {\n";
+    for (std::size_t i = 0; i < displacements.size(); ++i) {
+        out << (i % 8 == 0 ? "    " : " ") << displacements[i] << "u," << (i % 8 == 7 ? "\n" : "");
+    }
+    out << (displacements.size() % 8 ? "\n" : "") << "};\n\n"
+        << "constexpr std::array<const char *, " << slots.size() << "> kSlots = {\n";
+    for (int slot : slots) {
+        out << "    " << (slot >= 0 ? '"' + words[slot] + '"' : std::string("nullptr")) << ",\n";
+    }
+    out << "};\n\n"
+        << "} // namespace BaseDictionaryTable\n";
+
+    // Write beside the target and swap it in, so an interrupted run never leaves half a table
+    const std::string partialPath = outputPath + ".partial";
+    {
+        std::ofstream output(partialPath, std::ios::binary | std::ios::trunc);
+        const std::string table = out.str();
+        if (!output || !output.write(table.data(), static_cast<std::streamsize>(table.size())) || !output.flush()) {
+            std::cerr << "Cannot write " << partialPath << '\n';
+            return 1;
+        }
+    }
+    std::remove(outputPath.c_str());
+    if (std::rename(partialPath.c_str(), outputPath.c_str()) != 0) {
+        std::cerr << "Cannot write " << outputPath << '\n';
+        std::remove(partialPath.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,40 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QStringList>
+
+#include "mappeddictionary.h"
+
+// Compiles a word list into the memory-mapped dictionary format:
+//   screenqt_mkdict <words.txt | hunspell.dic> <output.sqtdict>
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    if (args.size() != 3) {
+        qWarning("usage: screenqt_mkdict <words.txt | hunspell.dic> <output.sqtdict>");
+        return 2;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QString error;
+    const QStringList words = MappedDictionary::readWordList(args.at(1), &error);
+    if (!error.isEmpty()) {
+        qWarning("%s", qPrintable(error));
+        return 1;
+    }
+    if (!MappedDictionary::compile(words, args.at(2), &error)) {
+        qWarning("%s", qPrintable(error));
+        return 1;
+    }
+
+    MappedDictionary check;
+    if (!check.open(args.at(2), &error)) {
+        qWarning("%s", qPrintable(error));
+        return 1;
+    }
+    qInfo("%d words -> %s (%lld bytes) in %lld ms", check.wordCount(), qPrintable(args.at(2)),
+          QFileInfo(args.at(2)).size(), timer.elapsed());
+    return 0;
+}